@@ -0,0 +1,2083 @@
+#include "adaptive_list.hpp"
+#include "concurrent_lists.hpp"
+#include "frozen_list.hpp"
+#include "inline_string_list.hpp"
+#include "latency_histogram.hpp"
+#include "list_trace.hpp"
+#include "node_allocators.hpp"
+#include "packed_single_linked_list.hpp"
+#include "single_linked_list.hpp"
+#include "trivially_relocatable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfEventCounter {
+public:
+	// The kernel multiplexes the PMU when more events are open than it has
+	// counters (or the NMI watchdog holds one), and an event then counts only
+	// while it is scheduled. value is scaled by enabled/running time to the
+	// whole measurement, so ratios of two events cover the same window;
+	// multiplexed marks such estimates.
+	struct Reading {
+		uint64_t value = 0;
+		bool multiplexed = false;
+	};
+
+	PerfEventCounter(uint32_t type, uint64_t config) {
+#if defined(__linux__)
+		perf_event_attr attr{};
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.inherit = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		this->fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+		(void)type;
+		(void)config;
+#endif
+	}
+
+	PerfEventCounter(const PerfEventCounter&) = delete;
+	PerfEventCounter& operator=(const PerfEventCounter&) = delete;
+
+	~PerfEventCounter() {
+#if defined(__linux__)
+		if (this->fd_ >= 0) {
+			close(this->fd_);
+		}
+#endif
+	}
+
+	[[nodiscard]] bool IsAvailable() const noexcept {
+		return this->fd_ >= 0;
+	}
+
+	void Start() noexcept {
+#if defined(__linux__)
+		if (this->fd_ >= 0) {
+			ioctl(this->fd_, PERF_EVENT_IOC_RESET, 0);
+			ioctl(this->fd_, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	// Empty if the event could not be read or was never scheduled.
+	[[nodiscard]] std::optional<Reading> Stop() noexcept {
+#if defined(__linux__)
+		if (this->fd_ >= 0) {
+			ioctl(this->fd_, PERF_EVENT_IOC_DISABLE, 0);
+			uint64_t values[3] = {};  // value, time enabled, time running
+			if (read(this->fd_, values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)) && values[2] != 0) {
+				Reading reading;
+				reading.multiplexed = values[2] < values[1];
+				reading.value = reading.multiplexed
+					? static_cast<uint64_t>(static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]))
+					: values[0];
+				return reading;
+			}
+		}
+#endif
+		return std::nullopt;
+	}
+
+private:
+	int fd_ = -1;
+};
+
+class BenchmarkRunner {
+public:
+	struct Measurement {
+		double seconds = 0;
+		std::vector<std::optional<PerfEventCounter::Reading>> counters;
+	};
+
+	explicit BenchmarkRunner(bool collect_counters)
+		: collect_counters_(collect_counters) {}
+
+	[[nodiscard]] bool HasCounters() const {
+		if (!this->collect_counters_) {
+			return false;
+		}
+		for (const auto& event : Events()) {
+			if (PerfEventCounter(event.type, event.config).IsAvailable()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template <typename Func>
+	Measurement Measure(Func&& func) const {
+		std::vector<std::unique_ptr<PerfEventCounter>> counters;
+		if (this->collect_counters_) {
+			for (const auto& event : Events()) {
+				counters.push_back(std::make_unique<PerfEventCounter>(event.type, event.config));
+			}
+		}
+
+		for (auto& counter : counters) {
+			counter->Start();
+		}
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		Measurement measurement;
+		measurement.seconds = elapsed.count();
+		for (auto& counter : counters) {
+			measurement.counters.push_back(counter->Stop());
+		}
+		return measurement;
+	}
+
+	void Report(const std::string& name, const Measurement& measurement, size_t operations) const {
+		const double per_operation = 1.0 / static_cast<double>(std::max<size_t>(operations, 1));
+		std::cout << name << ": " << measurement.seconds * 1e3 << " ms, "
+			<< measurement.seconds * 1e9 * per_operation << " ns/op";
+		for (size_t i = 0; i < measurement.counters.size(); ++i) {
+			if (const auto& reading = measurement.counters[i]) {
+				std::cout << ", " << static_cast<double>(reading->value) * per_operation
+					<< ' ' << Events()[i].name << "/op" << (reading->multiplexed ? " (multiplexed)" : "");
+			}
+		}
+		std::cout << std::endl;
+	}
+
+private:
+	struct Event {
+		const char* name;
+		uint32_t type;
+		uint64_t config;
+	};
+
+	bool collect_counters_;
+
+	static const std::vector<Event>& Events() {
+#if defined(__linux__)
+		static const std::vector<Event> events = {
+			{ "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ "L1d-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+				| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+			{ "LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+			{ "dTLB-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB
+				| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+			{ "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		};
+#else
+		static const std::vector<Event> events;
+#endif
+		return events;
+	}
+};
+
+class SharedQueueScheduler {
+public:
+	using Task = std::function<void()>;
+
+	explicit SharedQueueScheduler(size_t worker_count) {
+		for (size_t i = 0; i < std::max<size_t>(worker_count, 1); ++i) {
+			this->threads_.emplace_back([this] { WorkerLoop(); });
+		}
+	}
+
+	~SharedQueueScheduler() {
+		Wait();
+		{
+			std::lock_guard lock(this->mutex_);
+			this->stop_ = true;
+		}
+		this->work_cv_.notify_all();
+		for (auto& thread : this->threads_) {
+			thread.join();
+		}
+	}
+
+	void Submit(Task task) {
+		{
+			std::lock_guard lock(this->mutex_);
+			++this->pending_;
+			this->tasks_.PushFront(std::move(task));
+		}
+		this->work_cv_.notify_one();
+	}
+
+	void Wait() {
+		std::unique_lock lock(this->mutex_);
+		this->done_cv_.wait(lock, [this] { return this->pending_ == 0; });
+	}
+
+private:
+	SingleLinkedList<Task> tasks_;
+	size_t pending_ = 0;
+	bool stop_ = false;
+	std::mutex mutex_;
+	std::condition_variable work_cv_;
+	std::condition_variable done_cv_;
+	std::vector<std::thread> threads_;
+
+	void WorkerLoop() {
+		std::unique_lock lock(this->mutex_);
+		while (true) {
+			this->work_cv_.wait(lock, [this] { return this->stop_ || !this->tasks_.IsEmpty(); });
+			if (this->tasks_.IsEmpty()) {
+				return;
+			}
+			Task task = std::move(*this->tasks_.begin());
+			this->tasks_.PopFront();
+			lock.unlock();
+			task();
+			lock.lock();
+			if (--this->pending_ == 0) {
+				this->done_cv_.notify_all();
+			}
+		}
+	}
+};
+
+template <typename Scheduler>
+void RunImbalancedForkJoin(Scheduler& scheduler, int depth, std::atomic<size_t>& leaves) {
+	std::function<void(int)> node = [&](int level) {
+		if (level <= 0) {
+			volatile size_t value = static_cast<size_t>(level);
+			for (int i = 0; i < 200; ++i) {
+				value = value * 6364136223846793005u + 1442695040888963407u;
+			}
+			leaves.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		scheduler.Submit([&node, level] { node(level - 1); });
+		scheduler.Submit([&node, level] { node(level - 3); });
+	};
+
+	scheduler.Submit([&node, depth] { node(depth); });
+	scheduler.Wait();
+}
+
+void BenchmarkWorkStealingScheduler(const BenchmarkRunner& runner) {
+	constexpr int kDepth = 28;
+	const size_t max_workers = std::max(1u, std::thread::hardware_concurrency());
+
+	for (size_t workers = 1; workers <= max_workers; workers *= 2) {
+		std::atomic<size_t> shared_leaves{ 0 };
+		std::atomic<size_t> stealing_leaves{ 0 };
+		{
+			SharedQueueScheduler scheduler(workers);
+			const auto measurement = runner.Measure([&] { RunImbalancedForkJoin(scheduler, kDepth, shared_leaves); });
+			runner.Report("fork-join shared queue, " + std::to_string(workers) + " workers", measurement, shared_leaves);
+		}
+		{
+			WorkStealingScheduler scheduler(workers);
+			const auto measurement = runner.Measure([&] { RunImbalancedForkJoin(scheduler, kDepth, stealing_leaves); });
+			runner.Report("fork-join work stealing, " + std::to_string(workers) + " workers", measurement, stealing_leaves);
+		}
+		assert(shared_leaves == stealing_leaves);
+	}
+}
+
+void BenchmarkParallelTransformReduce(const BenchmarkRunner& runner) {
+	constexpr int kSize = 1 << 18;
+	SingleLinkedList<int> numbers;
+	for (int i = 0; i < kSize; ++i) {
+		numbers.PushFront(i);
+	}
+
+	auto heavy = [](int x) {
+		double value = x;
+		for (int i = 0; i < 64; ++i) {
+			value = value * 0.999 + 1.0 / (1.0 + value);
+		}
+		return value;
+	};
+
+	const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+		for (bool prefetch : { false, true }) {
+			double sum = 0;
+			const auto measurement = runner.Measure([&] {
+				sum = numbers.ParallelTransformReduce(0.0, std::plus<>{}, heavy, threads, prefetch);
+			});
+			runner.Report("parallel transform-reduce, " + std::to_string(threads) + " threads"
+				+ (prefetch ? ", prefetch" : ""), measurement, kSize);
+			assert(sum > 0);
+		}
+	}
+}
+
+void BenchmarkShardedBag(const BenchmarkRunner& runner) {
+	constexpr size_t kOperationsPerThread = 1 << 16;
+	const size_t max_threads = std::max(1u, std::thread::hardware_concurrency()) * 2;
+
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+		auto run = [&](auto&& push, auto&& pop) {
+			std::vector<std::thread> threads;
+			for (size_t t = 0; t < thread_count; ++t) {
+				threads.emplace_back([&] {
+					for (size_t i = 0; i < kOperationsPerThread; ++i) {
+						push(static_cast<int>(i));
+						if (i % 2 == 1) {
+							pop();
+						}
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+		};
+		const size_t operations = thread_count * kOperationsPerThread * 3 / 2;
+
+		{
+			std::mutex mutex;
+			SingleLinkedList<int> shared;
+			const auto measurement = runner.Measure([&] {
+				run([&](int value) {
+					std::lock_guard lock(mutex);
+					shared.PushFront(value);
+				}, [&] {
+					std::lock_guard lock(mutex);
+					if (!shared.IsEmpty()) {
+						shared.PopFront();
+					}
+				});
+			});
+			runner.Report("shared list, " + std::to_string(thread_count) + " threads", measurement, operations);
+		}
+		{
+			ShardedBag<int> bag;
+			const auto measurement = runner.Measure([&] {
+				run([&](int value) { bag.Push(value); }, [&] { (void)bag.TryPop(); });
+			});
+			runner.Report("sharded bag, " + std::to_string(thread_count) + " threads", measurement, operations);
+		}
+	}
+}
+
+void BenchmarkRcuReads(const BenchmarkRunner& runner) {
+	constexpr size_t kReadsPerThread = 1 << 14;
+	SingleLinkedList<int> routes;
+	for (int i = 0; i < 64; ++i) {
+		routes.PushFront(i);
+	}
+	const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+		auto run = [&](auto&& read, auto&& write) {
+			std::atomic<bool> done{ false };
+			std::thread writer([&] {
+				while (!done.load(std::memory_order_relaxed)) {
+					write();
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			});
+			std::vector<std::thread> readers;
+			for (size_t t = 0; t < thread_count; ++t) {
+				readers.emplace_back([&] {
+					for (size_t i = 0; i < kReadsPerThread; ++i) {
+						read();
+					}
+				});
+			}
+			for (auto& reader : readers) {
+				reader.join();
+			}
+			done = true;
+			writer.join();
+		};
+		const size_t operations = thread_count * kReadsPerThread;
+
+		{
+			std::mutex mutex;
+			SingleLinkedList<int> table = routes;
+			const auto measurement = runner.Measure([&] {
+				run([&] {
+					std::lock_guard lock(mutex);
+					volatile long sum = std::accumulate(table.begin(), table.end(), 0L);
+					(void)sum;
+				}, [&] {
+					SingleLinkedList<int> update = routes;
+					std::lock_guard lock(mutex);
+					table = std::move(update);
+				});
+			});
+			runner.Report("mutex-guarded reads, " + std::to_string(thread_count) + " readers", measurement, operations);
+		}
+		{
+			RcuList<int> table;
+			table.Assign(routes);
+			const auto measurement = runner.Measure([&] {
+				run([&] {
+					auto snapshot = table.Read();
+					volatile long sum = std::accumulate(snapshot.begin(), snapshot.end(), 0L);
+					(void)sum;
+				}, [&] {
+					table.Replace(0, 1);
+				});
+			});
+			runner.Report("rcu reads, " + std::to_string(thread_count) + " readers", measurement, operations);
+		}
+	}
+}
+
+template <typename List>
+BenchmarkRunner::Measurement RunInsertEraseThreads(const BenchmarkRunner& runner, size_t thread_count, size_t rounds) {
+	return runner.Measure([&] {
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < thread_count; ++t) {
+			threads.emplace_back([rounds] {
+				List list;
+				for (size_t round = 0; round < rounds; ++round) {
+					auto pos = list.cbefore_begin();
+					for (int i = 0; i < 256; ++i) {
+						pos = list.InsertAfter(pos, i);
+					}
+					while (!list.IsEmpty()) {
+						list.EraseAfter(list.cbefore_begin());
+					}
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	});
+}
+
+void BenchmarkNodeCache(const BenchmarkRunner& runner) {
+	constexpr size_t kRounds = 2000;
+	const size_t max_threads = std::max(1u, std::thread::hardware_concurrency()) * 2;
+
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+		const size_t operations = thread_count * kRounds * 256 * 2;
+		runner.Report("insert/erase std::allocator, " + std::to_string(thread_count) + " threads",
+			RunInsertEraseThreads<SingleLinkedList<int>>(runner, thread_count, kRounds), operations);
+		runner.Report("insert/erase node cache, " + std::to_string(thread_count) + " threads",
+			RunInsertEraseThreads<SingleLinkedList<int, NodeCacheAllocator<int>>>(runner, thread_count, kRounds), operations);
+	}
+}
+
+void BenchmarkHugePageArena(const BenchmarkRunner& runner) {
+	constexpr size_t kNodes = size_t{ 1 } << 22;
+	constexpr size_t kStripes = 1024;
+	using ArenaList = SingleLinkedList<int, ArenaAllocator<int>>;
+
+	for (HugePages huge_pages : { HugePages::kNone, HugePages::kTransparent, HugePages::kExplicit }) {
+		NodeArena arena(huge_pages);
+		ArenaAllocator<int> alloc(arena);
+		std::vector<ArenaList> stripes;
+		std::vector<ArenaList::ConstIterator> lasts(kStripes);
+		for (size_t i = 0; i < kStripes; ++i) {
+			stripes.emplace_back(alloc);
+		}
+		for (size_t i = 0; i < kNodes; ++i) {
+			ArenaList& stripe = stripes[i % kStripes];
+			stripe.PushFront(static_cast<int>(i));
+			if (stripe.GetSize() == 1) {
+				lasts[i % kStripes] = stripe.cbegin();
+			}
+		}
+
+		ArenaList list(alloc);
+		auto last = list.cbefore_begin();
+		for (size_t i = 0; i < kStripes; ++i) {
+			list.Concat(last, std::move(stripes[i]));
+			last = lasts[i];
+		}
+
+		long sum = 0;
+		const auto measurement = runner.Measure([&] {
+			sum = std::accumulate(list.begin(), list.end(), 0L);
+		});
+
+		const char* mode = arena.GetHugePages() == HugePages::kExplicit ? "explicit"
+			: arena.GetHugePages() == HugePages::kTransparent ? "transparent" : "none";
+		runner.Report(std::string("strided traversal, huge pages: ") + mode, measurement, kNodes);
+		assert(sum == static_cast<long>(kNodes * (kNodes - 1) / 2));
+	}
+}
+
+class TickClock {
+public:
+	TickClock()
+		: ns_per_tick_(Calibrate()) {}
+
+	[[nodiscard]] static uint64_t Now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	[[nodiscard]] double ToNanoseconds(uint64_t ticks) const noexcept {
+		return static_cast<double>(ticks) * this->ns_per_tick_;
+	}
+
+private:
+	double ns_per_tick_;
+
+	static double Calibrate() {
+		const auto start_time = std::chrono::steady_clock::now();
+		const uint64_t start_ticks = Now();
+		while (std::chrono::steady_clock::now() - start_time < std::chrono::milliseconds(20)) {
+		}
+		const uint64_t ticks = Now() - start_ticks;
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start_time;
+		return ticks == 0 ? 1.0 : elapsed.count() / static_cast<double>(ticks);
+	}
+};
+
+void ReportLatency(const std::string& name, const LatencyHistogram& histogram, const TickClock& clock) {
+	std::cout << name << ": p50 " << clock.ToNanoseconds(histogram.Percentile(50))
+		<< " ns, p90 " << clock.ToNanoseconds(histogram.Percentile(90))
+		<< " ns, p99 " << clock.ToNanoseconds(histogram.Percentile(99))
+		<< " ns, p99.9 " << clock.ToNanoseconds(histogram.Percentile(99.9))
+		<< " ns, max " << clock.ToNanoseconds(histogram.GetMax()) << " ns" << std::endl;
+}
+
+template <typename List>
+void MeasureOperationLatencies(const std::string& label, const typename List::allocator_type& alloc, const TickClock& clock) {
+	constexpr int kOperations = 1 << 17;
+	constexpr int kDestroyedLists = 256;
+	constexpr int kDestroyedListSize = 1024;
+
+	LatencyHistogram push_front;
+	LatencyHistogram insert_after;
+	LatencyHistogram erase_after;
+	LatencyHistogram pop_front;
+	LatencyHistogram destroy;
+
+	List list(alloc);
+	for (int i = 0; i < kOperations; ++i) {
+		const uint64_t start = TickClock::Now();
+		list.PushFront(i);
+		push_front.Record(TickClock::Now() - start);
+	}
+	for (int i = 0; i < kOperations; ++i) {
+		const uint64_t start = TickClock::Now();
+		list.InsertAfter(list.cbegin(), i);
+		insert_after.Record(TickClock::Now() - start);
+	}
+	for (int i = 0; i < kOperations; ++i) {
+		const uint64_t start = TickClock::Now();
+		list.EraseAfter(list.cbegin());
+		erase_after.Record(TickClock::Now() - start);
+	}
+	for (int i = 0; i < kOperations; ++i) {
+		const uint64_t start = TickClock::Now();
+		list.PopFront();
+		pop_front.Record(TickClock::Now() - start);
+	}
+
+	for (int i = 0; i < kDestroyedLists; ++i) {
+		auto doomed = std::make_unique<List>(alloc);
+		for (int j = 0; j < kDestroyedListSize; ++j) {
+			doomed->PushFront(j);
+		}
+		const uint64_t start = TickClock::Now();
+		doomed.reset();
+		destroy.Record(TickClock::Now() - start);
+	}
+
+	ReportLatency("PushFront latency, " + label, push_front, clock);
+	ReportLatency("InsertAfter latency, " + label, insert_after, clock);
+	ReportLatency("EraseAfter latency, " + label, erase_after, clock);
+	ReportLatency("PopFront latency, " + label, pop_front, clock);
+	ReportLatency("~SingleLinkedList latency (" + std::to_string(kDestroyedListSize) + " nodes), " + label, destroy, clock);
+}
+
+void BenchmarkOperationLatencies() {
+	const TickClock clock;
+	MeasureOperationLatencies<SingleLinkedList<int>>("std::allocator", {}, clock);
+	MeasureOperationLatencies<SingleLinkedList<int, NodeCacheAllocator<int>>>("node cache", {}, clock);
+
+	NodeArena arena;
+	MeasureOperationLatencies<SingleLinkedList<int, ArenaAllocator<int>>>("node arena", ArenaAllocator<int>(arena), clock);
+}
+
+class SlotPermutationArena {
+public:
+	explicit SlotPermutationArena(std::vector<uint32_t> order)
+		: order_(std::move(order)) {}
+
+	[[nodiscard]] void* Allocate(size_t bytes) {
+		if (this->slots_ == nullptr) {
+			this->slot_size_ = (bytes + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+			this->slots_.reset(new std::max_align_t[this->order_.size() * this->slot_size_ / sizeof(std::max_align_t)]);
+		}
+		if (bytes > this->slot_size_ || this->next_ == this->order_.size()) {
+			throw std::bad_alloc();
+		}
+		return reinterpret_cast<char*>(this->slots_.get()) + size_t{ this->order_[this->next_++] } * this->slot_size_;
+	}
+
+private:
+	std::vector<uint32_t> order_;
+	std::unique_ptr<std::max_align_t[]> slots_;
+	size_t slot_size_ = 0;
+	size_t next_ = 0;
+};
+
+template <typename Type>
+class SlotPermutationAllocator {
+	template <typename Other>
+	friend class SlotPermutationAllocator;
+
+public:
+	using value_type = Type;
+
+	explicit SlotPermutationAllocator(SlotPermutationArena& arena) noexcept
+		: arena_(&arena) {}
+
+	template <typename Other>
+	SlotPermutationAllocator(const SlotPermutationAllocator<Other>& other) noexcept
+		: arena_(other.arena_) {}
+
+	[[nodiscard]] Type* allocate(size_t count) {
+		assert(count == 1);
+		return static_cast<Type*>(this->arena_->Allocate(count * sizeof(Type)));
+	}
+
+	void deallocate(Type*, size_t) noexcept {}
+
+	template <typename Other>
+	[[nodiscard]] bool operator==(const SlotPermutationAllocator<Other>& rhs) const noexcept {
+		return this->arena_ == rhs.arena_;
+	}
+
+	template <typename Other>
+	[[nodiscard]] bool operator!=(const SlotPermutationAllocator<Other>& rhs) const noexcept {
+		return this->arena_ != rhs.arena_;
+	}
+
+private:
+	SlotPermutationArena* arena_;
+};
+
+template <typename List>
+void AppendSequentially(List& list, size_t count) {
+	auto last = list.cbefore_begin();
+	for (size_t i = 0; i < count; ++i) {
+		last = list.InsertAfter(last, static_cast<int>(i));
+	}
+}
+
+// Mean absolute distance in bytes between the elements of consecutive
+// nodes: close to the node size for a sequential layout, a large fraction
+// of the footprint once the nodes are scattered.
+template <typename List>
+double MeanNodeDistance(const List& list) {
+	double total = 0;
+	size_t steps = 0;
+	const auto* previous = static_cast<const void*>(nullptr);
+	for (const auto& value : list) {
+		const void* current = std::addressof(value);
+		if (previous != nullptr) {
+			const auto from = reinterpret_cast<uintptr_t>(previous);
+			const auto to = reinterpret_cast<uintptr_t>(current);
+			total += static_cast<double>(from < to ? to - from : from - to);
+			++steps;
+		}
+		previous = current;
+	}
+	return steps == 0 ? 0.0 : total / static_cast<double>(steps);
+}
+
+template <typename List>
+void MeasureTraversal(const BenchmarkRunner& runner, const std::string& placement, size_t bytes, const List& list) {
+	constexpr size_t kMinVisitedElements = size_t{ 1 } << 24;
+	const size_t passes = std::max<size_t>(3, kMinVisitedElements / std::max<size_t>(list.GetSize(), 1));
+
+	long sum = 0;
+	const auto measurement = runner.Measure([&] {
+		for (size_t pass = 0; pass < passes; ++pass) {
+			sum += std::accumulate(list.begin(), list.end(), 0L);
+		}
+	});
+
+	std::string size = bytes >= (size_t{ 1 } << 30) ? std::to_string(bytes >> 30) + " GiB"
+		: bytes >= (size_t{ 1 } << 20) ? std::to_string(bytes >> 20) + " MiB"
+		: std::to_string(bytes >> 10) + " KiB";
+	runner.Report("traversal " + placement + ", " + size, measurement, passes * list.GetSize());
+	std::cout << "traversal " << placement << ", " << size << ": mean node distance "
+		<< MeanNodeDistance(list) << " bytes" << std::endl;
+	assert(sum >= 0);
+}
+
+void BenchmarkCacheHierarchySweep(const BenchmarkRunner& runner) {
+	constexpr size_t kNodeBytes = 2 * sizeof(void*);
+	size_t max_bytes = size_t{ 4 } << 30;
+#if defined(__linux__)
+	const long pages = sysconf(_SC_PHYS_PAGES);
+	const long page_size = sysconf(_SC_PAGE_SIZE);
+	if (pages > 0 && page_size > 0) {
+		max_bytes = std::min(max_bytes, static_cast<size_t>(pages) * static_cast<size_t>(page_size) / 8);
+	}
+#endif
+
+	std::mt19937_64 random(42);
+	for (size_t bytes = size_t{ 1 } << 10; bytes <= max_bytes; bytes *= 4) {
+		const size_t count = bytes / kNodeBytes;
+		std::vector<uint32_t> order(count);
+		std::iota(order.begin(), order.end(), 0u);
+
+		{
+			SlotPermutationArena arena(order);
+			SingleLinkedList<int, SlotPermutationAllocator<int>> list(SlotPermutationAllocator<int>{ arena });
+			AppendSequentially(list, count);
+			MeasureTraversal(runner, "sequential", bytes, list);
+		}
+		{
+			std::shuffle(order.begin(), order.end(), random);
+			SlotPermutationArena arena(std::move(order));
+			SingleLinkedList<int, SlotPermutationAllocator<int>> list(SlotPermutationAllocator<int>{ arena });
+			AppendSequentially(list, count);
+			MeasureTraversal(runner, "random permutation", bytes, list);
+		}
+		{
+			std::vector<std::unique_ptr<char[]>> noise;
+			noise.reserve(count);
+			SingleLinkedList<int> list;
+			auto last = list.cbefore_begin();
+			for (size_t i = 0; i < count; ++i) {
+				last = list.InsertAfter(last, static_cast<int>(i));
+				noise.emplace_back(new char[16 + random() % 48]);
+			}
+			MeasureTraversal(runner, "interleaved", bytes, list);
+		}
+		{
+			// Erasing a node and inserting one in its place would get the same
+			// chunk straight back from malloc. Free a random half in one pass
+			// instead, then insert as many at random positions in another, so
+			// the recycled chunks land away from their old neighbours.
+			SingleLinkedList<int> list;
+			AppendSequentially(list, count);
+			for (int round = 0; round < 4; ++round) {
+				size_t erased = 0;
+				for (auto pos = list.cbefore_begin(); std::next(pos) != list.cend();) {
+					if (random() % 2 == 0) {
+						list.EraseAfter(pos);
+						++erased;
+					}
+					else {
+						++pos;
+					}
+				}
+				size_t ahead = list.GetSize();
+				for (auto pos = list.cbefore_begin(); erased > 0;) {
+					if (random() % (ahead + erased) < erased) {
+						pos = list.InsertAfter(pos, round);
+						--erased;
+					}
+					else {
+						++pos;
+						--ahead;
+					}
+				}
+			}
+			MeasureTraversal(runner, "post-churn", bytes, list);
+		}
+	}
+}
+
+template <typename Type>
+class ForwardListAdapter {
+public:
+	using ConstIterator = typename std::forward_list<Type>::const_iterator;
+
+	[[nodiscard]] ConstIterator begin() const noexcept {
+		return this->list_.begin();
+	}
+
+	[[nodiscard]] ConstIterator end() const noexcept {
+		return this->list_.end();
+	}
+
+	[[nodiscard]] ConstIterator cbefore_begin() const noexcept {
+		return this->list_.cbefore_begin();
+	}
+
+	void PushFront(const Type& value) {
+		this->list_.push_front(value);
+	}
+
+	void PopFront() noexcept {
+		this->list_.pop_front();
+	}
+
+	void InsertAfter(ConstIterator pos, const Type& value) {
+		this->list_.insert_after(pos, value);
+	}
+
+	void EraseAfter(ConstIterator pos) noexcept {
+		this->list_.erase_after(pos);
+	}
+
+	void Clear() noexcept {
+		this->list_.clear();
+	}
+
+private:
+	std::forward_list<Type> list_;
+};
+
+template <typename List>
+long ReplayTrace(const std::vector<TraceRecord>& trace, List& list) {
+	auto cursor = list.cbefore_begin();
+	size_t cursor_index = 0;
+	auto seek = [&](size_t index) {
+		if (index < cursor_index) {
+			cursor = list.cbefore_begin();
+			cursor_index = 0;
+		}
+		for (; cursor_index < index; ++cursor_index) {
+			++cursor;
+		}
+	};
+
+	long checksum = 0;
+	int value = 0;
+	for (const TraceRecord& record : trace) {
+		switch (record.operation) {
+		case TraceOperation::kPushFront:
+			list.PushFront(value);
+			cursor_index += cursor_index > 0 ? 1 : 0;
+			break;
+		case TraceOperation::kPopFront:
+			list.PopFront();
+			cursor = list.cbefore_begin();
+			cursor_index = 0;
+			break;
+		case TraceOperation::kInsertAfter:
+			seek(record.position);
+			list.InsertAfter(cursor, value);
+			break;
+		case TraceOperation::kEraseAfter:
+			seek(record.position);
+			list.EraseAfter(cursor);
+			break;
+		case TraceOperation::kIterate:
+			checksum += std::accumulate(list.begin(), list.end(), 0L);
+			break;
+		case TraceOperation::kClear:
+			list.Clear();
+			cursor = list.cbefore_begin();
+			cursor_index = 0;
+			break;
+		}
+		++value;
+	}
+	return checksum;
+}
+
+std::vector<TraceRecord> RecordSyntheticTrace(size_t operations) {
+	std::stringstream buffer;
+	TraceWriter writer(buffer);
+	TracingList<int> list(writer);
+	std::mt19937 random(7);
+
+	for (size_t i = 0; i < operations; ++i) {
+		const unsigned roll = random() % 1000;
+		const size_t distance = list.IsEmpty() ? 0 : random() % std::min<size_t>(list.GetSize(), 64);
+		auto pos = list.before_begin();
+		for (size_t step = 0; step < distance; ++step) {
+			++pos;
+		}
+
+		if (roll < 400 || list.IsEmpty()) {
+			list.PushFront(static_cast<int>(i));
+		}
+		else if (roll < 650) {
+			list.InsertAfter(pos, static_cast<int>(i));
+		}
+		else if (roll < 850) {
+			list.EraseAfter(pos);
+		}
+		else if (roll < 999) {
+			list.PopFront();
+		}
+		else {
+			list.ForEach([](int) {});
+		}
+	}
+
+	TraceReader reader(buffer);
+	return reader.ReadAll();
+}
+
+void ReplayOnAllTargets(const BenchmarkRunner& runner, const std::string& label, const std::vector<TraceRecord>& trace) {
+	std::optional<long> expected;
+	auto replay = [&](const std::string& target, auto& list) {
+		long checksum = 0;
+		const auto measurement = runner.Measure([&] { checksum = ReplayTrace(trace, list); });
+		runner.Report("replay " + label + ", " + target, measurement, trace.size());
+		assert(!expected || *expected == checksum);
+		expected = checksum;
+	};
+
+	{
+		SingleLinkedList<int> list;
+		replay("SingleLinkedList", list);
+	}
+	{
+		SingleLinkedList<int, NodeCacheAllocator<int>> list;
+		replay("SingleLinkedList + node cache", list);
+	}
+	{
+		NodeArena arena;
+		SingleLinkedList<int, ArenaAllocator<int>> list(ArenaAllocator<int>{ arena });
+		replay("SingleLinkedList + node arena", list);
+	}
+	{
+		ForwardListAdapter<int> list;
+		replay("std::forward_list", list);
+	}
+}
+
+void BenchmarkTraceReplay(const BenchmarkRunner& runner) {
+	ReplayOnAllTargets(runner, "synthetic trace", RecordSyntheticTrace(1 << 19));
+}
+
+template <size_t Bytes>
+struct ScalabilityPayload {
+	size_t key = 0;
+	std::array<char, Bytes> bytes{};
+};
+
+template <typename Payload>
+class MutexListTarget {
+public:
+	static constexpr const char* kName = "mutex SingleLinkedList";
+
+	explicit MutexListTarget(size_t key_range)
+		: key_range_(key_range) {
+		for (size_t key = 0; key < key_range / 2; ++key) {
+			this->list_.PushFront(Payload{ key });
+		}
+	}
+
+	void Read(size_t key) {
+		std::lock_guard lock(this->mutex_);
+		volatile bool found = std::any_of(this->list_.begin(), this->list_.end(),
+			[key](const Payload& payload) { return payload.key == key; });
+		(void)found;
+	}
+
+	void Write(size_t key) {
+		std::lock_guard lock(this->mutex_);
+		if (key % 2 == 0 && this->list_.GetSize() < this->key_range_) {
+			this->list_.PushFront(Payload{ key });
+		}
+		else if (!this->list_.IsEmpty()) {
+			this->list_.PopFront();
+		}
+	}
+
+private:
+	size_t key_range_;
+	std::mutex mutex_;
+	SingleLinkedList<Payload> list_;
+};
+
+template <typename Payload>
+class ShardedBagTarget {
+public:
+	static constexpr const char* kName = "ShardedBag";
+
+	explicit ShardedBagTarget(size_t key_range) {
+		for (size_t key = 0; key < key_range / 2; ++key) {
+			this->bag_.Push(Payload{ key });
+		}
+	}
+
+	void Read(size_t) {
+		if (auto payload = this->bag_.TryPop()) {
+			this->bag_.Push(std::move(*payload));
+		}
+	}
+
+	void Write(size_t key) {
+		if (key % 2 == 0) {
+			this->bag_.Push(Payload{ key });
+		}
+		else {
+			(void)this->bag_.TryPop();
+		}
+	}
+
+private:
+	ShardedBag<Payload> bag_;
+};
+
+template <typename Payload>
+class RcuListTarget {
+public:
+	static constexpr const char* kName = "RcuList";
+
+	explicit RcuListTarget(size_t key_range)
+		: size_(std::max<size_t>(key_range / 2, 1)) {
+		SingleLinkedList<Payload> initial;
+		for (size_t key = 0; key < this->size_; ++key) {
+			initial.PushFront(Payload{ key });
+		}
+		this->list_.Assign(initial);
+	}
+
+	void Read(size_t key) {
+		auto snapshot = this->list_.Read();
+		volatile bool found = std::any_of(snapshot.begin(), snapshot.end(),
+			[key](const Payload& payload) { return payload.key == key; });
+		(void)found;
+	}
+
+	void Write(size_t key) {
+		this->list_.Replace(key % this->size_, Payload{ key });
+	}
+
+private:
+	size_t size_;
+	RcuList<Payload> list_;
+};
+
+// Lock-free baselines for the suite. TreiberStackTarget pops and pushes
+// nodes of a fixed pool, so a node read after it was popped elsewhere is
+// still valid memory, and a tag packed next to the head index defeats ABA.
+template <typename Payload>
+class TreiberStackTarget {
+public:
+	static constexpr const char* kName = "Treiber stack";
+
+	explicit TreiberStackTarget(size_t key_range)
+		: nodes_(new Node[std::max<size_t>(key_range, 1)]) {
+		const auto node_count = static_cast<uint32_t>(std::max<size_t>(key_range, 1));
+		for (uint32_t i = 0; i < node_count; ++i) {
+			this->nodes_[i].payload.key = i;
+			Push(i < node_count / 2 ? this->items_ : this->free_, i);
+		}
+	}
+
+	void Read(size_t) {
+		const uint32_t index = Pop(this->items_);
+		if (index != kNil) {
+			Push(this->items_, index);
+		}
+	}
+
+	void Write(size_t key) {
+		if (key % 2 == 0) {
+			const uint32_t index = Pop(this->free_);
+			if (index != kNil) {
+				this->nodes_[index].payload.key = key;
+				Push(this->items_, index);
+			}
+		}
+		else {
+			const uint32_t index = Pop(this->items_);
+			if (index != kNil) {
+				Push(this->free_, index);
+			}
+		}
+	}
+
+private:
+	static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+	struct Node {
+		Payload payload;
+		std::atomic<uint32_t> next{ kNil };
+	};
+
+	// Head index in the low half, a modification count in the high half.
+	using Head = std::atomic<uint64_t>;
+
+	std::unique_ptr<Node[]> nodes_;
+	alignas(64) Head items_{ kNil };
+	alignas(64) Head free_{ kNil };
+
+	void Push(Head& head, uint32_t index) {
+		uint64_t old_head = head.load(std::memory_order_relaxed);
+		do {
+			this->nodes_[index].next.store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+		} while (!head.compare_exchange_weak(old_head, ((old_head >> 32) + 1) << 32 | index,
+			std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	uint32_t Pop(Head& head) {
+		uint64_t old_head = head.load(std::memory_order_acquire);
+		while (static_cast<uint32_t>(old_head) != kNil) {
+			const uint32_t next = this->nodes_[static_cast<uint32_t>(old_head)].next.load(std::memory_order_relaxed);
+			if (head.compare_exchange_weak(old_head, ((old_head >> 32) + 1) << 32 | next,
+				std::memory_order_acquire, std::memory_order_acquire)) {
+				return static_cast<uint32_t>(old_head);
+			}
+		}
+		return kNil;
+	}
+};
+
+// Intrusive multi-producer single-consumer queue: a push is one exchange on
+// the head, a pop follows next from the consumer-owned tail. Threads take
+// the consumer role with a try-lock and give up at once if it is held, as a
+// polling consumer would; writes push while the queue holds fewer than
+// key_range items.
+template <typename Payload>
+class MpscQueueTarget {
+public:
+	static constexpr const char* kName = "MPSC queue";
+
+	explicit MpscQueueTarget(size_t key_range)
+		: key_range_(key_range) {
+		for (size_t key = 0; key < key_range / 2; ++key) {
+			Push(key);
+		}
+	}
+
+	MpscQueueTarget(const MpscQueueTarget&) = delete;
+	MpscQueueTarget& operator=(const MpscQueueTarget&) = delete;
+
+	~MpscQueueTarget() {
+		for (Node* node = this->tail_; node != nullptr;) {
+			Node* next = node->next.load(std::memory_order_relaxed);
+			delete node;
+			node = next;
+		}
+	}
+
+	void Read(size_t) {
+		TryConsume();
+	}
+
+	void Write(size_t key) {
+		if (this->size_.load(std::memory_order_relaxed) < this->key_range_) {
+			Push(key);
+		}
+		else {
+			TryConsume();
+		}
+	}
+
+private:
+	struct Node {
+		std::atomic<Node*> next{ nullptr };
+		Payload payload;
+	};
+
+	size_t key_range_;
+	Node* tail_ = new Node();
+	alignas(64) std::atomic<Node*> head_{ tail_ };
+	alignas(64) std::atomic<size_t> size_{ 0 };
+	alignas(64) std::atomic<bool> consuming_{ false };
+
+	void Push(size_t key) {
+		Node* node = new Node();
+		node->payload.key = key;
+		this->size_.fetch_add(1, std::memory_order_relaxed);
+		Node* previous = this->head_.exchange(node, std::memory_order_acq_rel);
+		previous->next.store(node, std::memory_order_release);
+	}
+
+	void TryConsume() {
+		if (this->consuming_.exchange(true, std::memory_order_acquire)) {
+			return;
+		}
+		Node* next = this->tail_->next.load(std::memory_order_acquire);
+		if (next != nullptr) {
+			volatile size_t key = next->payload.key;
+			(void)key;
+			delete this->tail_;
+			this->tail_ = next;
+			this->size_.fetch_sub(1, std::memory_order_relaxed);
+		}
+		this->consuming_.store(false, std::memory_order_release);
+	}
+};
+
+// Harris lock-free ordered set: a node is deleted by first marking the low
+// bit of its own next link, then unlinking it from its predecessor, so an
+// insert after a node being deleted fails its CAS and retries. Traversals of
+// writers help unlink marked nodes. Unlinked nodes are only retired, and
+// freed when the target is destroyed, so the run measures the list itself
+// rather than a reclamation scheme. A write removes its key when present
+// and inserts it otherwise.
+template <typename Payload>
+class HarrisListTarget {
+public:
+	static constexpr const char* kName = "Harris list";
+
+	explicit HarrisListTarget(size_t key_range) {
+		for (size_t key = 0; key < key_range; key += 2) {
+			Insert(key);
+		}
+	}
+
+	HarrisListTarget(const HarrisListTarget&) = delete;
+	HarrisListTarget& operator=(const HarrisListTarget&) = delete;
+
+	~HarrisListTarget() {
+		for (Node* node = Pointer(this->head_.load(std::memory_order_relaxed)); node != nullptr;) {
+			Node* next = Pointer(node->next.load(std::memory_order_relaxed));
+			delete node;
+			node = next;
+		}
+		for (Node* node = this->retired_.load(std::memory_order_relaxed); node != nullptr;) {
+			Node* next = node->retired_next;
+			delete node;
+			node = next;
+		}
+	}
+
+	void Read(size_t key) {
+		Node* current = Pointer(this->head_.load(std::memory_order_acquire));
+		while (current != nullptr && current->payload.key < key) {
+			current = Pointer(current->next.load(std::memory_order_acquire));
+		}
+		volatile bool found = current != nullptr && current->payload.key == key
+			&& !IsMarked(current->next.load(std::memory_order_acquire));
+		(void)found;
+	}
+
+	void Write(size_t key) {
+		if (!Remove(key)) {
+			Insert(key);
+		}
+	}
+
+private:
+	// Links hold a Node pointer with the deletion mark in the low bit.
+	using Link = std::atomic<uintptr_t>;
+
+	struct Node {
+		Payload payload;
+		Link next{ 0 };
+		Node* retired_next = nullptr;
+	};
+
+	alignas(64) Link head_{ 0 };
+	alignas(64) std::atomic<Node*> retired_{ nullptr };
+
+	[[nodiscard]] static bool IsMarked(uintptr_t link) noexcept {
+		return (link & 1) != 0;
+	}
+
+	[[nodiscard]] static Node* Pointer(uintptr_t link) noexcept {
+		return reinterpret_cast<Node*>(link & ~uintptr_t{ 1 });
+	}
+
+	[[nodiscard]] static uintptr_t LinkTo(Node* node) noexcept {
+		return reinterpret_cast<uintptr_t>(node);
+	}
+
+	// Sets current to the first node with a key not below key and previous
+	// to the link that points at it, unlinking marked nodes on the way.
+	// Returns whether current holds key.
+	bool Find(size_t key, Link*& previous, Node*& current) {
+		for (;;) {
+			previous = &this->head_;
+			current = Pointer(previous->load(std::memory_order_acquire));
+			bool restart = false;
+			while (current != nullptr) {
+				const uintptr_t next = current->next.load(std::memory_order_acquire);
+				if (IsMarked(next)) {
+					uintptr_t expected = LinkTo(current);
+					if (!previous->compare_exchange_strong(expected, next & ~uintptr_t{ 1 },
+						std::memory_order_acq_rel, std::memory_order_acquire)) {
+						restart = true;
+						break;
+					}
+					Retire(current);
+					current = Pointer(next);
+					continue;
+				}
+				if (current->payload.key >= key) {
+					return current->payload.key == key;
+				}
+				previous = &current->next;
+				current = Pointer(next);
+			}
+			if (!restart) return false;
+		}
+	}
+
+	void Insert(size_t key) {
+		Node* node = nullptr;
+		Link* previous = nullptr;
+		Node* current = nullptr;
+		while (!Find(key, previous, current)) {
+			if (node == nullptr) {
+				node = new Node();
+				node->payload.key = key;
+			}
+			node->next.store(LinkTo(current), std::memory_order_relaxed);
+			uintptr_t expected = LinkTo(current);
+			if (previous->compare_exchange_strong(expected, LinkTo(node),
+				std::memory_order_release, std::memory_order_relaxed)) {
+				return;
+			}
+		}
+		delete node;
+	}
+
+	bool Remove(size_t key) {
+		Link* previous = nullptr;
+		Node* current = nullptr;
+		for (;;) {
+			if (!Find(key, previous, current)) return false;
+			uintptr_t next = current->next.load(std::memory_order_acquire);
+			if (IsMarked(next) || !current->next.compare_exchange_strong(next, next | 1,
+				std::memory_order_acq_rel, std::memory_order_acquire)) {
+				continue;
+			}
+			uintptr_t expected = LinkTo(current);
+			if (previous->compare_exchange_strong(expected, next,
+				std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				Retire(current);
+			}
+			else {
+				Find(key, previous, current);
+			}
+			return true;
+		}
+	}
+
+	void Retire(Node* node) {
+		node->retired_next = this->retired_.load(std::memory_order_relaxed);
+		while (!this->retired_.compare_exchange_weak(node->retired_next, node,
+			std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+};
+
+struct ScalabilityConfig {
+	size_t thread_count = 1;
+	unsigned read_percent = 90;
+	size_t key_range = 1024;
+	std::chrono::milliseconds duration{ 50 };
+};
+
+void PinThreadToCore([[maybe_unused]] size_t index) {
+#if defined(__linux__)
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(index % cores, &cpus);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
+
+template <typename Target>
+void RunScalabilityCase(const std::string& payload_label, const ScalabilityConfig& config) {
+	struct alignas(64) ThreadCounter {
+		std::atomic<uint64_t> operations{ 0 };
+	};
+
+	Target target(config.key_range);
+	std::vector<ThreadCounter> counters(config.thread_count);
+	std::atomic<bool> start{ false };
+	std::atomic<bool> stop{ false };
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < config.thread_count; ++t) {
+		threads.emplace_back([&, t] {
+			PinThreadToCore(t);
+			uint64_t state = 0x9e3779b97f4a7c15u * (t + 1);
+			while (!start.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+			while (!stop.load(std::memory_order_relaxed)) {
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				const size_t key = static_cast<size_t>(state >> 8) % config.key_range;
+				if (state % 100 < config.read_percent) {
+					target.Read(key);
+				}
+				else {
+					target.Write(key);
+				}
+				counters[t].operations.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	constexpr auto kSampleInterval = std::chrono::milliseconds(5);
+	size_t stalled_samples = 0;
+	size_t max_stalled_samples = 0;
+	uint64_t last_total = 0;
+	const auto begin = std::chrono::steady_clock::now();
+	start.store(true, std::memory_order_release);
+	while (std::chrono::steady_clock::now() - begin < config.duration) {
+		std::this_thread::sleep_for(kSampleInterval);
+		uint64_t total = 0;
+		for (const auto& counter : counters) {
+			total += counter.operations.load(std::memory_order_relaxed);
+		}
+		stalled_samples = total == last_total ? stalled_samples + 1 : 0;
+		max_stalled_samples = std::max(max_stalled_samples, stalled_samples);
+		last_total = total;
+	}
+	stop.store(true, std::memory_order_relaxed);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+	double sum = 0;
+	double sum_of_squares = 0;
+	uint64_t min_operations = std::numeric_limits<uint64_t>::max();
+	uint64_t max_operations = 0;
+	for (const auto& counter : counters) {
+		const uint64_t operations = counter.operations.load(std::memory_order_relaxed);
+		sum += static_cast<double>(operations);
+		sum_of_squares += static_cast<double>(operations) * static_cast<double>(operations);
+		min_operations = std::min(min_operations, operations);
+		max_operations = std::max(max_operations, operations);
+	}
+	const double fairness = sum_of_squares == 0 ? 0 : sum * sum / (static_cast<double>(config.thread_count) * sum_of_squares);
+	const double mean = sum / static_cast<double>(config.thread_count);
+
+	std::cout << "scalability " << Target::kName << ", payload " << payload_label
+		<< ", " << config.read_percent << "% reads, keys " << config.key_range
+		<< ", " << config.thread_count << " threads: " << sum / elapsed.count() / 1e6 << " Mops/s"
+		<< ", fairness " << fairness << ", per-thread ops min/max " << min_operations << '/' << max_operations;
+	if (static_cast<double>(min_operations) < mean / 100) {
+		std::cout << ", STARVATION";
+	}
+	if (max_stalled_samples * kSampleInterval >= config.duration / 4) {
+		std::cout << ", STALL (no progress for " << max_stalled_samples * kSampleInterval.count() << " ms)";
+	}
+	std::cout << std::endl;
+}
+
+template <size_t PayloadBytes>
+void RunScalabilitySuite(const ScalabilityConfig& config) {
+	using Payload = ScalabilityPayload<PayloadBytes>;
+	const std::string payload_label = std::to_string(sizeof(Payload)) + " B";
+	RunScalabilityCase<MutexListTarget<Payload>>(payload_label, config);
+	RunScalabilityCase<ShardedBagTarget<Payload>>(payload_label, config);
+	RunScalabilityCase<RcuListTarget<Payload>>(payload_label, config);
+	RunScalabilityCase<TreiberStackTarget<Payload>>(payload_label, config);
+	RunScalabilityCase<MpscQueueTarget<Payload>>(payload_label, config);
+	RunScalabilityCase<HarrisListTarget<Payload>>(payload_label, config);
+}
+
+void BenchmarkConcurrentScalability() {
+	const size_t max_threads = std::max(1u, std::thread::hardware_concurrency()) * 2;
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+		for (unsigned read_percent : { 50u, 90u, 99u }) {
+			for (size_t key_range : { size_t{ 64 }, size_t{ 1024 } }) {
+				ScalabilityConfig config;
+				config.thread_count = thread_count;
+				config.read_percent = read_percent;
+				config.key_range = key_range;
+				RunScalabilitySuite<8>(config);
+				RunScalabilitySuite<248>(config);
+			}
+		}
+	}
+}
+
+template <typename Type, typename Make>
+void MeasureCompact(const BenchmarkRunner& runner, const std::string& name, Make make) {
+	constexpr size_t kNodes = size_t{ 1 } << 20;
+	constexpr size_t kStripes = 1024;
+	using List = SingleLinkedList<Type>;
+
+	std::vector<List> stripes(kStripes);
+	std::vector<typename List::ConstIterator> lasts(kStripes);
+	for (size_t i = 0; i < kNodes; ++i) {
+		List& stripe = stripes[i % kStripes];
+		stripe.PushFront(make(i));
+		if (stripe.GetSize() == 1) {
+			lasts[i % kStripes] = stripe.cbegin();
+		}
+	}
+	List list;
+	auto last = list.cbefore_begin();
+	for (size_t i = 0; i < kStripes; ++i) {
+		list.Concat(last, std::move(stripes[i]));
+		last = lasts[i];
+	}
+
+	size_t visited = 0;
+	const auto traverse = [&] {
+		visited = 0;
+		for (const Type& item : list) {
+			visited += sizeof(item) != 0;
+		}
+	};
+	runner.Report("traversal before compact, " + name, runner.Measure(traverse), kNodes);
+	runner.Report("compact, " + name, runner.Measure([&] { list.Compact(); }), kNodes);
+	runner.Report("traversal after compact, " + name, runner.Measure(traverse), kNodes);
+	assert(visited == kNodes);
+}
+
+void BenchmarkCompact(const BenchmarkRunner& runner) {
+	MeasureCompact<long>(runner, "long (trivially relocatable)", [](size_t i) {
+		return static_cast<long>(i);
+	});
+	MeasureCompact<std::unique_ptr<long>>(runner, "unique_ptr (trivially relocatable)", [](size_t i) {
+		return std::make_unique<long>(static_cast<long>(i));
+	});
+	MeasureCompact<std::string>(runner, std::string("string (") + (kIsTriviallyRelocatable<std::string> ? "trivially relocatable)" : "move and destroy)"), [](size_t i) {
+		return std::to_string(i);
+	});
+}
+
+template <typename SizePolicy>
+void MeasureSizePolicy(const BenchmarkRunner& runner, const std::string& name) {
+	constexpr size_t kOperations = size_t{ 1 } << 22;
+	constexpr size_t kResident = 64;
+	using List = SingleLinkedList<int, NodeCacheAllocator<int>, SizePolicy>;
+
+	List list;
+	for (size_t i = 0; i < kResident; ++i) {
+		list.PushFront(static_cast<int>(i));
+	}
+	const auto pos = std::next(list.cbegin(), kResident / 2);
+
+	const auto measurement = runner.Measure([&] {
+		for (size_t i = 0; i < kOperations; ++i) {
+			list.InsertAfter(pos, static_cast<int>(i));
+			list.PushFront(static_cast<int>(i));
+			list.EraseAfter(pos);
+			list.PopFront();
+		}
+	});
+	runner.Report("insert/erase/push/pop, " + name, measurement, 4 * kOperations);
+	assert(list.GetSize() == kResident);
+}
+
+void BenchmarkSizePolicy(const BenchmarkRunner& runner) {
+	MeasureSizePolicy<TrackedSize>(runner, "tracked size");
+	MeasureSizePolicy<UntrackedSize>(runner, "untracked size");
+}
+
+template <typename Type>
+void MeasurePackedList(const BenchmarkRunner& runner, const std::string& name) {
+	constexpr size_t kElements = size_t{ 1 } << 22;
+	const Type needle = static_cast<Type>(1);
+	const auto value_at = [](size_t i) {
+		return static_cast<Type>(std::is_same_v<Type, bool> ? i % 3 == 0 : i % 251 + 2);
+	};
+
+	AllocationStats packed_stats;
+	PackedSingleLinkedList<Type, CountingAllocator<Type>> packed(CountingAllocator<Type>{ packed_stats });
+	auto pos = packed.cbefore_begin();
+	for (size_t i = 0; i < kElements; ++i) {
+		pos = packed.InsertAfter(pos, value_at(i));
+	}
+
+	AllocationStats node_stats;
+	std::forward_list<Type, CountingAllocator<Type>> nodes(CountingAllocator<Type>{ node_stats });
+	auto node_pos = nodes.cbefore_begin();
+	for (size_t i = 0; i < kElements; ++i) {
+		node_pos = nodes.insert_after(node_pos, value_at(i));
+	}
+
+	std::cout << name << " memory: packed " << static_cast<double>(packed_stats.bytes_allocated) / kElements
+		<< " bytes/element, node per element " << static_cast<double>(node_stats.bytes_allocated) / kElements
+		<< " bytes/element before allocator overhead" << std::endl;
+
+	size_t packed_count = 0;
+	size_t node_count = 0;
+	runner.Report(name + " count, packed", runner.Measure([&] { packed_count = packed.Count(needle); }), kElements);
+	runner.Report(name + " count, node per element", runner.Measure([&] {
+		node_count = static_cast<size_t>(std::count(nodes.begin(), nodes.end(), needle));
+	}), kElements);
+	assert(packed_count == node_count);
+
+	const Type missing = static_cast<Type>(std::is_same_v<Type, bool> ? 0 : 1);
+	bool packed_found = false;
+	bool node_found = false;
+	if constexpr (!std::is_same_v<Type, bool>) {
+		runner.Report(name + " find missing, packed", runner.Measure([&] {
+			packed_found = packed.Find(missing) != packed.end();
+		}), kElements);
+		runner.Report(name + " find missing, node per element", runner.Measure([&] {
+			node_found = std::find(nodes.begin(), nodes.end(), missing) != nodes.end();
+		}), kElements);
+	}
+	assert(packed_found == node_found);
+}
+
+void BenchmarkPackedList(const BenchmarkRunner& runner) {
+	MeasurePackedList<bool>(runner, "bool");
+	MeasurePackedList<uint8_t>(runner, "uint8_t");
+}
+
+std::vector<std::string> MakeTokens(size_t count) {
+	std::mt19937 random(42);
+	std::uniform_int_distribution<size_t> length(2, 40);
+	std::uniform_int_distribution<int> letter('a', 'z');
+	std::vector<std::string> tokens(count);
+	for (std::string& token : tokens) {
+		token.resize(length(random));
+		for (char& c : token) {
+			c = static_cast<char>(letter(random));
+		}
+	}
+	return tokens;
+}
+
+template <typename List>
+size_t HashTokens(const List& list) {
+	size_t hash = 0;
+	for (const auto& token : list) {
+		const std::string_view view(token);
+		hash = hash * 31 + view.size() + static_cast<unsigned char>(view.back());
+	}
+	return hash;
+}
+
+void BenchmarkInlineStringList(const BenchmarkRunner& runner) {
+	constexpr size_t kTokens = size_t{ 1 } << 20;
+	const std::vector<std::string> tokens = MakeTokens(kTokens);
+
+	AllocationStats string_stats;
+	SingleLinkedList<std::string, CountingAllocator<std::string>> strings(CountingAllocator<std::string>{ string_stats });
+	runner.Report("tokenize into SingleLinkedList<std::string>", runner.Measure([&] {
+		auto pos = strings.cbefore_begin();
+		for (const std::string& token : tokens) {
+			pos = strings.InsertAfter(pos, token);
+		}
+	}), kTokens);
+
+	AllocationStats inline_stats;
+	InlineStringList<CountingAllocator<char>> inline_strings(CountingAllocator<char>{ inline_stats });
+	runner.Report("tokenize into InlineStringList", runner.Measure([&] {
+		auto pos = inline_strings.cbefore_begin();
+		for (const std::string& token : tokens) {
+			pos = inline_strings.InsertAfter(pos, token);
+		}
+	}), kTokens);
+
+	std::cout << "list allocations per token: SingleLinkedList<std::string> "
+		<< static_cast<double>(string_stats.allocations) / kTokens
+		<< " (string buffers beyond SSO come from the global heap on top), InlineStringList "
+		<< static_cast<double>(inline_stats.allocations) / kTokens << std::endl;
+
+	size_t string_hash = 0;
+	size_t inline_hash = 0;
+	runner.Report("traverse SingleLinkedList<std::string>", runner.Measure([&] { string_hash = HashTokens(strings); }), kTokens);
+	runner.Report("traverse InlineStringList", runner.Measure([&] { inline_hash = HashTokens(inline_strings); }), kTokens);
+	assert(string_hash == inline_hash);
+
+	runner.Report("clear SingleLinkedList<std::string>", runner.Measure([&] { strings.Clear(); }), kTokens);
+	runner.Report("clear InlineStringList", runner.Measure([&] { inline_strings.Clear(); }), kTokens);
+}
+
+void BenchmarkFrozenList(const BenchmarkRunner& runner) {
+	constexpr size_t kNodes = size_t{ 1 } << 22;
+	constexpr size_t kStripes = 1024;
+
+	std::vector<SingleLinkedList<long>> stripes(kStripes);
+	std::vector<SingleLinkedList<long>::ConstIterator> lasts(kStripes);
+	for (size_t i = 0; i < kNodes; ++i) {
+		SingleLinkedList<long>& stripe = stripes[i % kStripes];
+		stripe.PushFront(0);
+		if (stripe.GetSize() == 1) {
+			lasts[i % kStripes] = stripe.cbegin();
+		}
+	}
+	SingleLinkedList<long> list;
+	auto last = list.cbefore_begin();
+	for (size_t i = 0; i < kStripes; ++i) {
+		list.Concat(last, std::move(stripes[i]));
+		last = lasts[i];
+	}
+	std::mt19937 random(7);
+	long value = 0;
+	for (long& item : list) {
+		value += static_cast<long>(random() % 5) - 1;
+		item = value;
+	}
+
+	long expected = 0;
+	runner.Report("frozen: linked traversal", runner.Measure([&] {
+		expected = std::accumulate(list.begin(), list.end(), 0L);
+	}), kNodes);
+
+	std::optional<FrozenList<long>> frozen;
+	runner.Report("frozen: freeze", runner.Measure([&] { frozen.emplace(Freeze(list)); }), kNodes);
+	long sum = 0;
+	runner.Report("frozen: array traversal", runner.Measure([&] {
+		sum = std::accumulate(frozen->begin(), frozen->end(), 0L);
+	}), kNodes);
+	assert(sum == expected);
+
+	std::optional<CompressedFrozenList<long>> compressed;
+	runner.Report("frozen: freeze delta+varint", runner.Measure([&] { compressed.emplace(FreezeCompressed(list)); }), kNodes);
+	std::cout << "frozen: delta+varint " << static_cast<double>(compressed->GetEncodedBytes()) / kNodes
+		<< " bytes/element vs " << sizeof(long) << " plain" << std::endl;
+	runner.Report("frozen: delta+varint iterator traversal", runner.Measure([&] {
+		sum = std::accumulate(compressed->begin(), compressed->end(), 0L);
+	}), kNodes);
+	assert(sum == expected);
+	runner.Report("frozen: delta+varint batch traversal", runner.Measure([&] {
+		sum = 0;
+		compressed->ForEach([&](long element) { sum += element; });
+	}), kNodes);
+	assert(sum == expected);
+
+	SingleLinkedList<long> thawed;
+	runner.Report("frozen: thaw", runner.Measure([&] { thawed = std::move(*frozen).Thaw(); }), kNodes);
+	assert(thawed == list);
+}
+
+const char* RepresentationName(ListRepresentation representation) {
+	switch (representation) {
+	case ListRepresentation::kNodeList:
+		return "node list";
+	case ListRepresentation::kUnrolled:
+		return "unrolled";
+	case ListRepresentation::kArray:
+	default:
+		return "array";
+	}
+}
+
+// Front-insert build, then index-heavy lookups, then repeated scans.
+void RunPhasedWorkload(const BenchmarkRunner& runner, const std::string& name, AdaptivePolicy policy) {
+	constexpr size_t kElements = 20000;
+	constexpr size_t kLookups = 50000;
+	constexpr size_t kScans = 2000;
+
+	AdaptiveList<long> list(policy);
+	const auto build = runner.Measure([&] {
+		for (size_t i = 0; i < kElements; ++i) {
+			list.PushFront(static_cast<long>(i));
+		}
+	});
+	long sum = 0;
+	const auto lookups = runner.Measure([&] {
+		for (size_t i = 0; i < kLookups; ++i) {
+			sum += list.At(i * 7919 % kElements);
+		}
+	});
+	const auto scans = runner.Measure([&] {
+		for (size_t i = 0; i < kScans; ++i) {
+			list.ForEach([&](long value) { sum += value; });
+		}
+	});
+
+	runner.Report("adaptive workload, " + name + ", front inserts", build, kElements);
+	runner.Report("adaptive workload, " + name + ", lookups", lookups, kLookups);
+	runner.Report("adaptive workload, " + name + ", scans", scans, kScans * kElements);
+	const AdaptiveStats& stats = list.GetStats();
+	std::cout << "adaptive workload, " << name << ": " << stats.migrations << " migrations, ended as "
+		<< RepresentationName(stats.representation) << ", checksum " << sum << std::endl;
+}
+
+void BenchmarkAdaptiveList(const BenchmarkRunner& runner) {
+	RunPhasedWorkload(runner, "adaptive", AdaptivePolicy());
+	for (ListRepresentation representation : { ListRepresentation::kNodeList, ListRepresentation::kUnrolled, ListRepresentation::kArray }) {
+		AdaptivePolicy policy;
+		policy.initial = representation;
+		policy.enabled = false;
+		RunPhasedWorkload(runner, std::string("fixed ") + RepresentationName(representation), policy);
+	}
+}
+
+using PostingList = SingleLinkedList<uint32_t>;
+
+PostingList MakePostingList(size_t count, uint32_t max_gap, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<uint32_t> gap(1, max_gap);
+	PostingList list;
+	auto pos = list.cbefore_begin();
+	uint32_t doc = 0;
+	for (size_t i = 0; i < count; ++i) {
+		doc += gap(random);
+		pos = list.InsertAfter(pos, doc);
+	}
+	return list;
+}
+
+// Output iterator appending to a list: the baseline the in-place set
+// operations replace allocates one fresh list per result through it.
+class PostingAppender {
+public:
+	using iterator_category = std::output_iterator_tag;
+	using value_type = void;
+	using difference_type = std::ptrdiff_t;
+	using pointer = void;
+	using reference = void;
+
+	explicit PostingAppender(PostingList& list)
+		: list_(&list)
+		, pos_(list.cbefore_begin()) {}
+
+	PostingAppender& operator=(uint32_t value) {
+		this->pos_ = this->list_->InsertAfter(this->pos_, value);
+		return *this;
+	}
+
+	PostingAppender& operator*() {
+		return *this;
+	}
+
+	PostingAppender& operator++() {
+		return *this;
+	}
+
+	PostingAppender& operator++(int) {
+		return *this;
+	}
+
+private:
+	PostingList* list_;
+	PostingList::ConstIterator pos_;
+};
+
+void MeasureSortedSetOperations(const BenchmarkRunner& runner, size_t lhs_size, size_t rhs_size) {
+	// Gaps scale with the opposite list so both span the same document range.
+	const auto max_gap = [](size_t own, size_t other) {
+		return static_cast<uint32_t>(std::max<size_t>(2, 4 * std::max(own, other) / own));
+	};
+	const uint32_t lhs_gap = max_gap(lhs_size, rhs_size);
+	const uint32_t rhs_gap = max_gap(rhs_size, lhs_size);
+	const std::string label = std::to_string(lhs_size) + " x " + std::to_string(rhs_size);
+	const size_t operations = lhs_size + rhs_size;
+
+	const auto run_copying = [&](const std::string& name, auto algorithm) {
+		const PostingList lhs = MakePostingList(lhs_size, lhs_gap, 1);
+		const PostingList rhs = MakePostingList(rhs_size, rhs_gap, 2);
+		PostingList result;
+		runner.Report(name + " into new list, " + label, runner.Measure([&] {
+			algorithm(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), PostingAppender(result));
+		}), operations);
+		return result.GetSize();
+	};
+
+	[[maybe_unused]] size_t expected = run_copying("union", [](auto... args) { std::set_union(args...); });
+	PostingList lhs = MakePostingList(lhs_size, lhs_gap, 1);
+	PostingList rhs = MakePostingList(rhs_size, rhs_gap, 2);
+	runner.Report("union by relinking, " + label, runner.Measure([&] { lhs.UnionWith(std::move(rhs)); }), operations);
+	assert(lhs.GetSize() == expected);
+
+	expected = run_copying("intersection", [](auto... args) { std::set_intersection(args...); });
+	lhs = MakePostingList(lhs_size, lhs_gap, 1);
+	rhs = MakePostingList(rhs_size, rhs_gap, 2);
+	runner.Report("intersection in place, " + label, runner.Measure([&] { lhs.IntersectWith(rhs); }), operations);
+	assert(lhs.GetSize() == expected);
+
+	expected = run_copying("difference", [](auto... args) { std::set_difference(args...); });
+	lhs = MakePostingList(lhs_size, lhs_gap, 1);
+	runner.Report("difference in place, " + label, runner.Measure([&] { lhs.DifferenceWith(rhs); }), operations);
+	assert(lhs.GetSize() == expected);
+}
+
+void BenchmarkSortedSetOperations(const BenchmarkRunner& runner) {
+	constexpr size_t kLarge = size_t{ 1 } << 20;
+	constexpr size_t kSmall = size_t{ 1 } << 10;
+	MeasureSortedSetOperations(runner, kLarge, kLarge);
+	MeasureSortedSetOperations(runner, kLarge, kSmall);
+	MeasureSortedSetOperations(runner, kSmall, kLarge);
+}
+
+void BenchmarkMergeAll(const BenchmarkRunner& runner) {
+	constexpr size_t kRuns = 256;
+	constexpr size_t kRunLength = 1024;
+	constexpr size_t kElements = kRuns * kRunLength;
+
+	std::mt19937 random(7);
+	std::uniform_int_distribution<uint32_t> keys;
+	std::vector<std::vector<uint32_t>> sorted_runs(kRuns, std::vector<uint32_t>(kRunLength));
+	for (auto& run : sorted_runs) {
+		std::generate(run.begin(), run.end(), [&] { return keys(random); });
+		std::sort(run.begin(), run.end());
+	}
+
+	std::vector<std::forward_list<uint32_t>> pairwise_runs;
+	for (const auto& run : sorted_runs) {
+		pairwise_runs.emplace_back(run.begin(), run.end());
+	}
+	std::forward_list<uint32_t> pairwise;
+	runner.Report("repeated pairwise merge, " + std::to_string(kRuns) + " runs", runner.Measure([&] {
+		for (auto& run : pairwise_runs) {
+			pairwise.merge(run);
+		}
+	}), kElements);
+
+	const auto make_runs = [&] {
+		std::vector<SingleLinkedList<uint32_t>> runs(kRuns);
+		for (size_t i = 0; i < kRuns; ++i) {
+			auto pos = runs[i].cbefore_begin();
+			for (uint32_t key : sorted_runs[i]) {
+				pos = runs[i].InsertAfter(pos, key);
+			}
+		}
+		return runs;
+	};
+	for (size_t thread_count : { size_t{ 1 }, size_t{ 0 } }) {
+		std::vector<SingleLinkedList<uint32_t>> runs = make_runs();
+		SingleLinkedList<uint32_t> merged;
+		const std::string mode = thread_count == 1 ? "sequential" : std::to_string(std::max(1u, std::thread::hardware_concurrency())) + " threads";
+		runner.Report("MergeAll loser tree, " + std::to_string(kRuns) + " runs, " + mode, runner.Measure([&] {
+			merged = MergeAll(runs, std::less<>(), thread_count);
+		}), kElements);
+		assert(std::equal(merged.begin(), merged.end(), pairwise.begin(), pairwise.end()));
+	}
+}
+
+void BenchmarkApplyBatch(const BenchmarkRunner& runner) {
+	constexpr size_t kElements = size_t{ 1 } << 16;
+	constexpr size_t kEdits = 2048;
+	constexpr size_t kSpacing = kElements / kEdits;
+
+	// Alternating inserts and erases at increasing positions of the original list.
+	std::vector<BatchOperation<long>> operations;
+	for (size_t edit = 0; edit < kEdits; ++edit) {
+		const size_t index = edit * kSpacing + kSpacing / 2;
+		if (edit % 2 == 0) {
+			operations.push_back({ index, BatchOperationKind::kInsert, static_cast<long>(edit) });
+		}
+		else {
+			operations.push_back({ index, BatchOperationKind::kErase, std::nullopt });
+		}
+	}
+
+	const auto make_list = [] {
+		SingleLinkedList<long> list;
+		auto pos = list.cbefore_begin();
+		for (size_t i = 0; i < kElements; ++i) {
+			pos = list.InsertAfter(pos, static_cast<long>(i));
+		}
+		return list;
+	};
+
+	SingleLinkedList<long> one_by_one = make_list();
+	runner.Report("InsertAfter/EraseAfter from begin() per edit", runner.Measure([&] {
+		// Earlier edits shift later positions by one per insert, minus one per erase.
+		std::ptrdiff_t shift = 0;
+		for (const auto& operation : operations) {
+			const auto before = std::next(one_by_one.cbefore_begin(), static_cast<std::ptrdiff_t>(operation.index) + shift);
+			if (operation.kind == BatchOperationKind::kInsert) {
+				one_by_one.InsertAfter(before, *operation.value);
+				++shift;
+			}
+			else {
+				one_by_one.EraseAfter(before);
+				--shift;
+			}
+		}
+	}), kEdits);
+
+	SingleLinkedList<long> batched = make_list();
+	runner.Report("ApplyBatch", runner.Measure([&] { batched.ApplyBatch(operations); }), kEdits);
+	assert(batched == one_by_one);
+}
+
+void BenchmarkRangeInsertErase(const BenchmarkRunner& runner) {
+	constexpr size_t kElements = 10000;
+	constexpr size_t kRepeats = 100;
+	std::vector<long> values(kElements);
+	std::iota(values.begin(), values.end(), 0L);
+
+	SingleLinkedList<long> one_by_one{ -1, -2 };
+	runner.Report("InsertAfter/EraseAfter one element at a time", runner.Measure([&] {
+		for (size_t repeat = 0; repeat < kRepeats; ++repeat) {
+			auto pos = one_by_one.cbegin();
+			for (long value : values) {
+				pos = one_by_one.InsertAfter(pos, value);
+			}
+			for (size_t i = 0; i < kElements; ++i) {
+				one_by_one.EraseAfter(one_by_one.cbegin());
+			}
+		}
+	}), 2 * kElements * kRepeats);
+
+	SingleLinkedList<long> ranged{ -1, -2 };
+	runner.Report("InsertAfter/EraseAfter whole range", runner.Measure([&] {
+		for (size_t repeat = 0; repeat < kRepeats; ++repeat) {
+			const auto last = ranged.InsertAfter(ranged.cbegin(), values.begin(), values.end());
+			ranged.EraseAfter(ranged.cbegin(), std::next(last));
+		}
+	}), 2 * kElements * kRepeats);
+	assert(ranged == one_by_one && ranged.GetSize() == 2);
+}
+
+void RunBenchmarks(bool collect_counters) {
+	const BenchmarkRunner runner(collect_counters);
+	if (collect_counters && !runner.HasCounters()) {
+		std::cout << "hardware performance counters are unavailable, reporting wall-clock time only" << std::endl;
+	}
+
+	BenchmarkWorkStealingScheduler(runner);
+	BenchmarkParallelTransformReduce(runner);
+	BenchmarkShardedBag(runner);
+	BenchmarkRcuReads(runner);
+	BenchmarkNodeCache(runner);
+	BenchmarkHugePageArena(runner);
+	BenchmarkOperationLatencies();
+	BenchmarkCacheHierarchySweep(runner);
+	BenchmarkTraceReplay(runner);
+	BenchmarkCompact(runner);
+	BenchmarkSizePolicy(runner);
+	BenchmarkPackedList(runner);
+	BenchmarkInlineStringList(runner);
+	BenchmarkFrozenList(runner);
+	BenchmarkAdaptiveList(runner);
+	BenchmarkSortedSetOperations(runner);
+	BenchmarkMergeAll(runner);
+	BenchmarkApplyBatch(runner);
+	BenchmarkRangeInsertErase(runner);
+	BenchmarkConcurrentScalability();
+}
+
+int main(int argc, char* argv[]) {
+	if (argc > 2 && std::string(argv[1]) == "--replay") {
+		std::ifstream input(argv[2], std::ios::binary);
+		if (!input) {
+			std::cerr << "cannot open " << argv[2] << std::endl;
+			return 1;
+		}
+		TraceReader reader(input);
+		ReplayOnAllTargets(BenchmarkRunner(true), argv[2], reader.ReadAll());
+		return 0;
+	}
+
+	RunBenchmarks(!(argc > 1 && std::string(argv[1]) == "--no-counters"));
+	return 0;
+}
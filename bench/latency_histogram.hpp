@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class LatencyHistogram {
+public:
+	static constexpr int kSubBucketBits = 7;
+	static constexpr uint64_t kSubBucketCount = uint64_t{ 1 } << kSubBucketBits;
+
+	LatencyHistogram()
+		: counts_(kSubBucketCount * (64 - kSubBucketBits + 1)) {}
+
+	void Record(uint64_t value) noexcept {
+		++this->counts_[IndexOf(value)];
+		++this->total_;
+		this->max_ = std::max(this->max_, value);
+	}
+
+	[[nodiscard]] uint64_t GetTotal() const noexcept {
+		return this->total_;
+	}
+
+	[[nodiscard]] uint64_t GetMax() const noexcept {
+		return this->max_;
+	}
+
+	[[nodiscard]] uint64_t Percentile(double percentile) const noexcept {
+		if (this->total_ == 0) {
+			return 0;
+		}
+
+		const auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(this->total_)));
+		uint64_t seen = 0;
+		for (size_t index = 0; index < this->counts_.size(); ++index) {
+			seen += this->counts_[index];
+			if (seen >= std::max<uint64_t>(rank, 1)) {
+				return std::min(HighestEquivalentValue(index), this->max_);
+			}
+		}
+		return this->max_;
+	}
+
+private:
+	std::vector<uint64_t> counts_;
+	uint64_t total_ = 0;
+	uint64_t max_ = 0;
+
+	[[nodiscard]] static size_t IndexOf(uint64_t value) noexcept {
+		if (value < kSubBucketCount) {
+			return static_cast<size_t>(value);
+		}
+		int magnitude = 63;
+		while ((value >> magnitude) == 0) {
+			--magnitude;
+		}
+		const int shift = magnitude - kSubBucketBits;
+		return static_cast<size_t>(kSubBucketCount * (shift + 1) + ((value >> shift) - kSubBucketCount));
+	}
+
+	[[nodiscard]] static uint64_t HighestEquivalentValue(size_t index) noexcept {
+		if (index < kSubBucketCount) {
+			return index;
+		}
+		const int shift = static_cast<int>(index / kSubBucketCount) - 1;
+		const uint64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+		return ((sub_bucket + 1) << shift) - 1;
+	}
+};
@@ -0,0 +1,550 @@
+#pragma once
+
+#include "single_linked_list.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+enum class ListRepresentation {
+	kNodeList,
+	kUnrolled,
+	kArray,
+};
+
+// Estimated cost of one elementary step of each representation, in arbitrary
+// units (roughly nanoseconds on a desktop core). Element moves scale with
+// sizeof(Type), so large payloads favour nodes and small ones favour arrays.
+struct AdaptiveCostModel {
+	double node_hop = 4.0;
+	double block_hop = 4.0;
+	double byte_move = 0.0625;
+	double allocation = 20.0;
+	double node_scan = 4.0;
+	double unrolled_scan = 1.0;
+	double array_scan = 0.5;
+	// Indexing straight into contiguous storage. Nodes and blocks pay for
+	// random access through their hops instead.
+	double array_access = 1.0;
+};
+
+struct AdaptivePolicy {
+	ListRepresentation initial = ListRepresentation::kNodeList;
+	AdaptiveCostModel costs;
+	// Operations between two evaluations of the cost model.
+	size_t evaluation_window = 4096;
+	// The current representation must cost this many times the best one over
+	// a window before a migration is considered.
+	double hysteresis = 1.5;
+	// A migration must pay for itself within this many windows.
+	double payback_windows = 4.0;
+	bool enabled = true;
+};
+
+struct AdaptiveOperationCounts {
+	size_t front_inserts = 0;
+	size_t middle_inserts = 0;
+	size_t erases = 0;
+	size_t scans = 0;
+	size_t random_accesses = 0;
+};
+
+struct AdaptiveStats {
+	AdaptiveOperationCounts operations;
+	ListRepresentation representation = ListRepresentation::kNodeList;
+	size_t evaluations = 0;
+	size_t migrations = 0;
+	std::array<size_t, 3> migrations_to = {};
+	// Modelled cost of the last window under each representation, indexed by
+	// ListRepresentation.
+	std::array<double, 3> last_window_costs = {};
+};
+
+// Index-addressed sequence that counts its operation mix and migrates between
+// a SingleLinkedList, an unrolled list of small arrays and a std::vector when
+// the cost model says the move pays off.
+template <typename Type>
+class AdaptiveList {
+	static constexpr size_t kBlockCapacity = 16;
+
+	// Up to kBlockCapacity elements stored inline, so a block and its elements
+	// share the single allocation of their list node.
+	class Block {
+	public:
+		Block() noexcept {}
+
+		Block(const Block& other) {
+			Append(other.begin(), other.end());
+		}
+
+		Block(Block&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+			Append(Relocating(other.begin()), Relocating(other.end()));
+		}
+
+		Block& operator=(const Block&) = delete;
+
+		~Block() {
+			Truncate(0);
+		}
+
+		[[nodiscard]] size_t GetSize() const noexcept {
+			return this->size_;
+		}
+
+		[[nodiscard]] bool IsEmpty() const noexcept {
+			return this->size_ == 0;
+		}
+
+		[[nodiscard]] Type* begin() noexcept {
+			return std::launder(reinterpret_cast<Type*>(this->storage_));
+		}
+
+		[[nodiscard]] Type* end() noexcept {
+			return begin() + this->size_;
+		}
+
+		[[nodiscard]] const Type* begin() const noexcept {
+			return std::launder(reinterpret_cast<const Type*>(this->storage_));
+		}
+
+		[[nodiscard]] const Type* end() const noexcept {
+			return begin() + this->size_;
+		}
+
+		[[nodiscard]] Type& operator[](size_t index) noexcept {
+			assert(index < this->size_);
+			return begin()[index];
+		}
+
+		template <typename Value>
+		void PushBack(Value&& value) {
+			assert(this->size_ < kBlockCapacity);
+			::new (static_cast<void*>(begin() + this->size_)) Type(std::forward<Value>(value));
+			++this->size_;
+		}
+
+		void Insert(size_t index, Type&& value) {
+			assert(index <= this->size_);
+			if (index == this->size_) {
+				PushBack(std::move(value));
+				return;
+			}
+			Type* data = begin();
+			PushBack(std::move(data[this->size_ - 1]));
+			std::move_backward(data + index, data + this->size_ - 2, data + this->size_ - 1);
+			data[index] = std::move(value);
+		}
+
+		void Erase(size_t index) {
+			assert(index < this->size_);
+			Type* data = begin();
+			std::move(data + index + 1, data + this->size_, data + index);
+			Truncate(this->size_ - 1);
+		}
+
+		// Moves the elements from index on to the empty block other, copying
+		// them instead when their move can throw. If that throws, other is
+		// left empty again and this block keeps every element.
+		void MoveTailTo(size_t index, Block& other) {
+			assert(other.IsEmpty() && index <= this->size_);
+			Type* data = begin();
+			other.Append(Relocating(data + index), Relocating(data + this->size_));
+			Truncate(index);
+		}
+
+	private:
+		size_t size_ = 0;
+		alignas(Type) unsigned char storage_[sizeof(Type) * kBlockCapacity];
+
+		// Iterator that reads elements with std::move_if_noexcept semantics.
+		using Relocating = std::conditional_t<
+			std::is_nothrow_move_constructible_v<Type> || !std::is_copy_constructible_v<Type>,
+			std::move_iterator<Type*>, const Type*>;
+
+		template <typename Iterator>
+		void Append(Iterator first, Iterator last) {
+			try {
+				for (; first != last; ++first) {
+					PushBack(*first);
+				}
+			}
+			catch (...) {
+				Truncate(0);
+				throw;
+			}
+		}
+
+		void Truncate(size_t size) noexcept {
+			Type* data = begin();
+			for (; this->size_ > size; --this->size_) {
+				data[this->size_ - 1].~Type();
+			}
+		}
+	};
+
+public:
+	using value_type = Type;
+
+	explicit AdaptiveList(AdaptivePolicy policy = AdaptivePolicy())
+		: policy_(policy) {
+		this->stats_.representation = policy.initial;
+	}
+
+	[[nodiscard]] size_t GetSize() const noexcept {
+		return this->size_;
+	}
+
+	[[nodiscard]] bool IsEmpty() const noexcept {
+		return this->size_ == 0;
+	}
+
+	[[nodiscard]] ListRepresentation GetRepresentation() const noexcept {
+		return this->stats_.representation;
+	}
+
+	[[nodiscard]] const AdaptiveStats& GetStats() const noexcept {
+		return this->stats_;
+	}
+
+	void PushFront(Type value) {
+		Insert(0, std::move(value));
+	}
+
+	void Insert(size_t index, Type value) {
+		assert(index <= this->size_);
+
+		switch (this->stats_.representation) {
+		case ListRepresentation::kNodeList:
+			this->nodes_.InsertAfter(NodeBefore(index), std::move(value));
+			break;
+		case ListRepresentation::kUnrolled:
+			InsertIntoBlocks(index, std::move(value));
+			break;
+		case ListRepresentation::kArray:
+			this->array_.insert(this->array_.begin() + static_cast<std::ptrdiff_t>(index), std::move(value));
+			break;
+		}
+		++this->size_;
+
+		if (index == 0) {
+			Record(&AdaptiveOperationCounts::front_inserts, 0, 0);
+		}
+		else {
+			Record(&AdaptiveOperationCounts::middle_inserts, index, this->size_ - index);
+		}
+	}
+
+	void Erase(size_t index) {
+		assert(index < this->size_);
+
+		switch (this->stats_.representation) {
+		case ListRepresentation::kNodeList:
+			this->nodes_.EraseAfter(NodeBefore(index));
+			break;
+		case ListRepresentation::kUnrolled:
+			EraseFromBlocks(index);
+			break;
+		case ListRepresentation::kArray:
+			this->array_.erase(this->array_.begin() + static_cast<std::ptrdiff_t>(index));
+			break;
+		}
+		--this->size_;
+
+		Record(&AdaptiveOperationCounts::erases, index, this->size_ - index);
+	}
+
+	// Any later call, At and ForEach included, may migrate the list and
+	// invalidate the returned reference; fetch the element again instead of
+	// holding on to it.
+	[[nodiscard]] Type& At(size_t index) {
+		assert(index < this->size_);
+
+		Record(&AdaptiveOperationCounts::random_accesses, index, 0);
+
+		switch (this->stats_.representation) {
+		case ListRepresentation::kNodeList:
+			return *std::next(this->nodes_.begin(), static_cast<std::ptrdiff_t>(index));
+		case ListRepresentation::kUnrolled: {
+			auto block = this->blocks_.begin();
+			for (; index >= block->GetSize(); ++block) {
+				index -= block->GetSize();
+			}
+			return (*block)[index];
+		}
+		case ListRepresentation::kArray:
+		default:
+			return this->array_[index];
+		}
+	}
+
+	// References passed to fn are valid only for that call: a later call may
+	// migrate the list.
+	template <typename Func>
+	void ForEach(Func fn) {
+		Record(&AdaptiveOperationCounts::scans, 0, 0);
+		VisitValues(std::move(fn));
+	}
+
+	// Moves the elements into the given representation now, regardless of the
+	// cost model. Every node and block of the new form is allocated before the
+	// first element is relocated, and an element is moved only when that
+	// cannot throw and copied otherwise, so a failure leaves the list in its
+	// old representation with every element intact. Elements of a move-only
+	// type whose move can throw are the exception: those already moved are
+	// left in a valid but unspecified state.
+	void MigrateTo(ListRepresentation target) {
+		if (target == this->stats_.representation) return;
+
+		switch (target) {
+		case ListRepresentation::kNodeList: {
+			std::vector<Type*> values;
+			values.reserve(this->size_);
+			VisitValues([&values](Type& value) { values.push_back(std::addressof(value)); });
+			SingleLinkedList<Type> nodes;
+			nodes.InsertAfter(nodes.cbefore_begin(), RelocatingIterator(values.data()), RelocatingIterator(values.data() + values.size()));
+			ReleaseStorage();
+			this->nodes_ = std::move(nodes);
+			break;
+		}
+		case ListRepresentation::kUnrolled: {
+			SingleLinkedList<Block> blocks;
+			auto pos = blocks.cbefore_begin();
+			for (size_t i = 0; i < this->size_; i += kBlockCapacity) {
+				pos = blocks.InsertAfter(pos, Block());
+			}
+			auto block = blocks.begin();
+			VisitValues([&block](Type& value) {
+				if (block->GetSize() == kBlockCapacity) {
+					++block;
+				}
+				block->PushBack(std::move_if_noexcept(value));
+			});
+			ReleaseStorage();
+			this->blocks_ = std::move(blocks);
+			break;
+		}
+		case ListRepresentation::kArray: {
+			std::vector<Type> array;
+			array.reserve(this->size_);
+			VisitValues([&array](Type& value) {
+				array.push_back(std::move_if_noexcept(value));
+			});
+			ReleaseStorage();
+			this->array_ = std::move(array);
+			break;
+		}
+		}
+
+		this->stats_.representation = target;
+		++this->stats_.migrations;
+		++this->stats_.migrations_to[static_cast<size_t>(target)];
+	}
+
+private:
+	AdaptivePolicy policy_;
+	AdaptiveStats stats_;
+	AdaptiveOperationCounts window_;
+	size_t window_operations_ = 0;
+	size_t window_index_sum_ = 0;
+	size_t window_tail_sum_ = 0;
+	size_t size_ = 0;
+
+	SingleLinkedList<Type> nodes_;
+	SingleLinkedList<Block> blocks_;
+	std::vector<Type> array_;
+
+	// Forward iterator over element pointers that yields each element as an
+	// rvalue when moving it cannot throw and as a const lvalue otherwise.
+	class RelocatingIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Type*;
+		using reference = decltype(std::move_if_noexcept(std::declval<Type&>()));
+
+		explicit RelocatingIterator(Type* const* value) noexcept
+			: value_(value) {}
+
+		[[nodiscard]] bool operator==(const RelocatingIterator& rhs) const noexcept {
+			return this->value_ == rhs.value_;
+		}
+
+		[[nodiscard]] bool operator!=(const RelocatingIterator& rhs) const noexcept {
+			return this->value_ != rhs.value_;
+		}
+
+		RelocatingIterator& operator++() noexcept {
+			++this->value_;
+			return *this;
+		}
+
+		RelocatingIterator operator++(int) noexcept {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		[[nodiscard]] reference operator*() const noexcept {
+			return std::move_if_noexcept(**this->value_);
+		}
+
+	private:
+		Type* const* value_;
+	};
+
+	typename SingleLinkedList<Type>::ConstIterator NodeBefore(size_t index) const {
+		return std::next(this->nodes_.cbefore_begin(), static_cast<std::ptrdiff_t>(index));
+	}
+
+	void InsertIntoBlocks(size_t index, Type&& value) {
+		if (this->blocks_.IsEmpty()) {
+			this->blocks_.PushFront(Block());
+			try {
+				this->blocks_.begin()->PushBack(std::move(value));
+			}
+			catch (...) {
+				this->blocks_.PopFront();
+				throw;
+			}
+			return;
+		}
+
+		auto block = this->blocks_.begin();
+		while (index > block->GetSize()) {
+			index -= block->GetSize();
+			++block;
+		}
+		if (block->GetSize() == kBlockCapacity) {
+			auto upper = this->blocks_.InsertAfter(block, Block());
+			try {
+				block->MoveTailTo(kBlockCapacity / 2, *upper);
+			}
+			catch (...) {
+				this->blocks_.EraseAfter(block);
+				throw;
+			}
+			if (index > kBlockCapacity / 2) {
+				index -= kBlockCapacity / 2;
+				block = upper;
+			}
+		}
+		block->Insert(index, std::move(value));
+	}
+
+	void EraseFromBlocks(size_t index) {
+		auto before = this->blocks_.before_begin();
+		auto block = this->blocks_.begin();
+		while (index >= block->GetSize()) {
+			index -= block->GetSize();
+			before = block;
+			++block;
+		}
+		block->Erase(index);
+		if (block->IsEmpty()) {
+			this->blocks_.EraseAfter(before);
+		}
+	}
+
+	template <typename Func>
+	void VisitValues(Func fn) {
+		switch (this->stats_.representation) {
+		case ListRepresentation::kNodeList:
+			for (Type& value : this->nodes_) {
+				fn(value);
+			}
+			break;
+		case ListRepresentation::kUnrolled:
+			for (Block& block : this->blocks_) {
+				for (Type& value : block) {
+					fn(value);
+				}
+			}
+			break;
+		case ListRepresentation::kArray:
+			for (Type& value : this->array_) {
+				fn(value);
+			}
+			break;
+		}
+	}
+
+	void ReleaseStorage() noexcept {
+		this->nodes_.Clear();
+		this->blocks_.Clear();
+		this->array_ = std::vector<Type>();
+	}
+
+	// index_sum feeds the modelled hop count, tail_sum the modelled array moves.
+	void Record(size_t AdaptiveOperationCounts::*counter, size_t index_sum, size_t tail_sum) {
+		++(this->stats_.operations.*counter);
+		if (!this->policy_.enabled) return;
+
+		++(this->window_.*counter);
+		this->window_index_sum_ += index_sum;
+		this->window_tail_sum_ += tail_sum;
+		if (++this->window_operations_ >= this->policy_.evaluation_window) {
+			Evaluate();
+		}
+	}
+
+	void Evaluate() {
+		const AdaptiveCostModel& costs = this->policy_.costs;
+		const AdaptiveOperationCounts& ops = this->window_;
+		const double n = static_cast<double>(this->size_);
+		const double move = costs.byte_move * static_cast<double>(sizeof(Type));
+		const double index_sum = static_cast<double>(this->window_index_sum_);
+		const double tail_sum = static_cast<double>(this->window_tail_sum_);
+		const double front = static_cast<double>(ops.front_inserts);
+		const double middle = static_cast<double>(ops.middle_inserts);
+		const double erases = static_cast<double>(ops.erases);
+		const double accesses = static_cast<double>(ops.random_accesses);
+		const double scans = static_cast<double>(ops.scans);
+		const double block = static_cast<double>(kBlockCapacity);
+
+		std::array<double, 3> window_costs{};
+		window_costs[static_cast<size_t>(ListRepresentation::kNodeList)] =
+			(front + middle) * costs.allocation + index_sum * costs.node_hop + scans * n * costs.node_scan;
+		window_costs[static_cast<size_t>(ListRepresentation::kUnrolled)] =
+			(front + middle + erases) * (block / 2 * move) + (front + middle) * costs.allocation / block
+			+ index_sum / block * costs.block_hop + scans * n * costs.unrolled_scan;
+		window_costs[static_cast<size_t>(ListRepresentation::kArray)] =
+			front * n * move + tail_sum * move + accesses * costs.array_access + scans * n * costs.array_scan;
+
+		const auto current = static_cast<size_t>(this->stats_.representation);
+		size_t best = current;
+		for (size_t i = 0; i < window_costs.size(); ++i) {
+			if (window_costs[i] < window_costs[best]) {
+				best = i;
+			}
+		}
+
+		++this->stats_.evaluations;
+		this->stats_.last_window_costs = window_costs;
+		this->window_ = AdaptiveOperationCounts();
+		this->window_operations_ = 0;
+		this->window_index_sum_ = 0;
+		this->window_tail_sum_ = 0;
+
+		const double migration_cost = n * (move + costs.allocation);
+		const double saving = window_costs[current] - window_costs[best];
+		if (best != current && window_costs[current] > window_costs[best] * this->policy_.hysteresis
+			&& saving * this->policy_.payback_windows > migration_cost) {
+			// The operation that got here has already taken effect, so a
+			// migration that runs out of memory is skipped rather than
+			// reported; MigrateTo leaves the current representation intact.
+			try {
+				MigrateTo(static_cast<ListRepresentation>(best));
+			}
+			catch (const std::bad_alloc&) {
+			}
+		}
+	}
+};
@@ -0,0 +1,716 @@
+#pragma once
+
+#include "single_linked_list.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename Type>
+class ShardedBag {
+public:
+	explicit ShardedBag(size_t shard_count = std::max(1u, std::thread::hardware_concurrency()))
+		: shard_count_(std::max<size_t>(shard_count, 1))
+		, shards_(new Shard[shard_count_]) {}
+
+	ShardedBag(const ShardedBag&) = delete;
+	ShardedBag& operator=(const ShardedBag&) = delete;
+
+	[[nodiscard]] size_t GetShardCount() const noexcept {
+		return this->shard_count_;
+	}
+
+	void Push(const Type& value) {
+		Type copy(value);
+		Push(std::move(copy));
+	}
+
+	void Push(Type&& value) {
+		Shard& shard = this->shards_[LocalShardIndex()];
+		std::lock_guard lock(shard.mutex);
+		shard.items.PushFront(std::move(value));
+		if (shard.items.GetSize() == 1) {
+			shard.last = shard.items.cbegin();
+		}
+	}
+
+	[[nodiscard]] std::optional<Type> TryPop() {
+		const size_t local = LocalShardIndex();
+		for (size_t i = 0; i < this->shard_count_; ++i) {
+			Shard& shard = this->shards_[(local + i) % this->shard_count_];
+			std::lock_guard lock(shard.mutex);
+			if (shard.items.IsEmpty()) {
+				continue;
+			}
+			std::optional<Type> value(std::move(*shard.items.begin()));
+			shard.items.PopFront();
+			return value;
+		}
+		return std::nullopt;
+	}
+
+	[[nodiscard]] SingleLinkedList<Type> Collect() {
+		SingleLinkedList<Type> result;
+		auto result_last = result.cbefore_begin();
+		for (size_t i = 0; i < this->shard_count_; ++i) {
+			Shard& shard = this->shards_[i];
+			std::lock_guard lock(shard.mutex);
+			if (shard.items.IsEmpty()) {
+				continue;
+			}
+			result.Concat(result_last, std::move(shard.items));
+			result_last = shard.last;
+		}
+		return result;
+	}
+
+private:
+	struct alignas(64) Shard {
+		std::mutex mutex;
+		SingleLinkedList<Type> items;
+		typename SingleLinkedList<Type>::ConstIterator last;
+	};
+
+	size_t shard_count_;
+	std::unique_ptr<Shard[]> shards_;
+
+	[[nodiscard]] size_t LocalShardIndex() const noexcept {
+		static std::atomic<size_t> next_slot{ 0 };
+		thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+		return slot % this->shard_count_;
+	}
+};
+
+template <typename Type>
+class RcuList {
+	struct Node {
+		Node(const Type& val, const Node* next)
+			: value(val)
+			, next_node(next) {}
+
+		const Type value;
+		const Node* const next_node;
+	};
+
+	struct Version {
+		const Node* head = nullptr;
+		size_t size = 0;
+	};
+
+	// A reader announces the epoch it started in through a slot that only its
+	// thread writes, so Read never competes with other readers for a slot.
+	// depth counts nested guards of the owning thread.
+	struct alignas(64) ReaderSlot {
+		std::atomic<uint64_t> epoch{ 0 };
+		std::atomic<bool> owned{ false };
+		size_t depth = 0;
+		ReaderSlot* next = nullptr;
+	};
+
+public:
+	class ConstIterator {
+		friend class RcuList;
+
+		explicit ConstIterator(const Node* node)
+			: node_(node) {}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Type*;
+		using reference = const Type&;
+
+		ConstIterator() = default;
+
+		[[nodiscard]] bool operator==(const ConstIterator& rhs) const noexcept {
+			return this->node_ == rhs.node_;
+		}
+
+		[[nodiscard]] bool operator!=(const ConstIterator& rhs) const noexcept {
+			return this->node_ != rhs.node_;
+		}
+
+		ConstIterator& operator++() noexcept {
+			this->node_ = this->node_->next_node;
+			return *this;
+		}
+
+		ConstIterator operator++(int) noexcept {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		[[nodiscard]] reference operator*() const noexcept {
+			return this->node_->value;
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept {
+			return &this->node_->value;
+		}
+
+	private:
+		const Node* node_ = nullptr;
+	};
+
+	class ReadGuard {
+		friend class RcuList;
+
+		ReadGuard(ReaderSlot& slot, const Version* version) noexcept
+			: slot_(&slot)
+			, version_(version) {}
+
+	public:
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+		ReadGuard(ReadGuard&& other) noexcept
+			: slot_(std::exchange(other.slot_, nullptr))
+			, version_(other.version_) {}
+
+		~ReadGuard() {
+			if (this->slot_ != nullptr && --this->slot_->depth == 0) {
+				this->slot_->epoch.store(0, std::memory_order_release);
+			}
+		}
+
+		[[nodiscard]] ConstIterator begin() const noexcept {
+			return ConstIterator(this->version_->head);
+		}
+
+		[[nodiscard]] ConstIterator end() const noexcept {
+			return ConstIterator(nullptr);
+		}
+
+		[[nodiscard]] size_t GetSize() const noexcept {
+			return this->version_->size;
+		}
+
+		[[nodiscard]] bool IsEmpty() const noexcept {
+			return this->version_->size == 0;
+		}
+
+	private:
+		ReaderSlot* slot_;
+		const Version* version_;
+	};
+
+	// reader_slots slots are allocated up front; a thread takes one on its
+	// first Read and hands it back when it exits. If more threads read at once
+	// than there are free slots, the slot set grows instead of making them wait.
+	explicit RcuList(size_t reader_slots = 4 * std::max(1u, std::thread::hardware_concurrency()))
+		: slots_(std::make_shared<SlotRegistry>())
+		, current_(new Version()) {
+		for (size_t i = 0; i < reader_slots; ++i) {
+			auto slot = std::make_unique<ReaderSlot>();
+			slot->next = this->slots_->head.load(std::memory_order_relaxed);
+			this->slots_->head.store(slot.release(), std::memory_order_relaxed);
+		}
+	}
+
+	RcuList(const RcuList&) = delete;
+	RcuList& operator=(const RcuList&) = delete;
+
+	~RcuList() {
+		for (auto& retired : this->retired_) {
+			Free(retired);
+		}
+		const Version* version = this->current_.load(std::memory_order_relaxed);
+		for (const Node* node = version->head; node != nullptr;) {
+			const Node* next = node->next_node;
+			delete node;
+			node = next;
+		}
+		delete version;
+	}
+
+	// Wait-free once the calling thread holds a slot of this list; only its
+	// first Read may allocate one. The guard must be released on the thread
+	// that took it.
+	[[nodiscard]] ReadGuard Read() const {
+		ReaderSlot& slot = LocalSlot();
+		if (slot.depth++ == 0) {
+			slot.epoch.store(this->epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+		}
+		return ReadGuard(slot, this->current_.load(std::memory_order_seq_cst));
+	}
+
+	void PushFront(const Type& value) {
+		auto version = std::make_unique<Version>();
+		std::lock_guard lock(this->write_mutex_);
+		const Version* old_version = this->current_.load(std::memory_order_relaxed);
+		version->head = new Node(value, old_version->head);
+		version->size = old_version->size + 1;
+		Publish(version.release(), 0);
+	}
+
+	void Insert(size_t position, const Type& value) {
+		auto version = std::make_unique<Version>();
+		std::lock_guard lock(this->write_mutex_);
+		const Version* old_version = this->current_.load(std::memory_order_relaxed);
+		assert(position <= old_version->size);
+
+		const Node* suffix = SkipNodes(old_version->head, position);
+		version->head = CopyPrefix(old_version->head, position, new Node(value, suffix), suffix);
+		version->size = old_version->size + 1;
+		Publish(version.release(), position);
+	}
+
+	void Replace(size_t position, const Type& value) {
+		auto version = std::make_unique<Version>();
+		std::lock_guard lock(this->write_mutex_);
+		const Version* old_version = this->current_.load(std::memory_order_relaxed);
+		assert(position < old_version->size);
+
+		const Node* suffix = SkipNodes(old_version->head, position + 1);
+		version->head = CopyPrefix(old_version->head, position, new Node(value, suffix), suffix);
+		version->size = old_version->size;
+		Publish(version.release(), position + 1);
+	}
+
+	void Erase(size_t position) {
+		auto version = std::make_unique<Version>();
+		std::lock_guard lock(this->write_mutex_);
+		const Version* old_version = this->current_.load(std::memory_order_relaxed);
+		assert(position < old_version->size);
+
+		const Node* suffix = SkipNodes(old_version->head, position + 1);
+		version->head = CopyPrefix(old_version->head, position, suffix, suffix);
+		version->size = old_version->size - 1;
+		Publish(version.release(), position + 1);
+	}
+
+	void Assign(const SingleLinkedList<Type>& values) {
+		auto version = std::make_unique<Version>();
+		std::vector<const Type*> items;
+		items.reserve(values.GetSize());
+		for (const Type& value : values) {
+			items.push_back(&value);
+		}
+
+		try {
+			for (auto it = items.rbegin(); it != items.rend(); ++it) {
+				version->head = new Node(**it, version->head);
+			}
+		}
+		catch (...) {
+			DeleteChain(version->head, nullptr);
+			throw;
+		}
+		version->size = items.size();
+
+		std::lock_guard lock(this->write_mutex_);
+		Publish(version.release(), this->current_.load(std::memory_order_relaxed)->size);
+	}
+
+	void Reclaim() {
+		std::lock_guard lock(this->write_mutex_);
+		ReclaimRetired();
+	}
+
+	[[nodiscard]] size_t GetRetiredCount() const {
+		std::lock_guard lock(this->write_mutex_);
+		return this->retired_.size();
+	}
+
+private:
+	struct SlotRegistry {
+		std::atomic<ReaderSlot*> head{ nullptr };
+
+		~SlotRegistry() {
+			for (ReaderSlot* slot = this->head.load(std::memory_order_relaxed); slot != nullptr;) {
+				ReaderSlot* next = slot->next;
+				delete slot;
+				slot = next;
+			}
+		}
+	};
+
+	// The slots a thread holds, one per list it has read. Each entry keeps a
+	// weak reference to its registry: the registry is created by make_shared,
+	// so its address stays reserved until the entry is dropped and cannot be
+	// mistaken for a later list's registry.
+	struct LocalSlots {
+		struct Entry {
+			const SlotRegistry* registry;
+			std::weak_ptr<SlotRegistry> owner;
+			ReaderSlot* slot;
+		};
+
+		std::vector<Entry> entries;
+
+		~LocalSlots() {
+			for (const Entry& entry : this->entries) {
+				if (auto registry = entry.owner.lock()) {
+					entry.slot->owned.store(false, std::memory_order_release);
+				}
+			}
+		}
+	};
+
+	struct Retired {
+		uint64_t epoch;
+		const Version* version;
+		size_t node_count;
+	};
+
+	std::shared_ptr<SlotRegistry> slots_;
+	std::atomic<const Version*> current_;
+	alignas(64) std::atomic<uint64_t> epoch_{ 1 };
+	mutable std::mutex write_mutex_;
+	std::vector<Retired> retired_;
+
+	static const Node* SkipNodes(const Node* node, size_t count) noexcept {
+		for (; count > 0; --count) {
+			node = node->next_node;
+		}
+		return node;
+	}
+
+	static void DeleteChain(const Node* first, const Node* last) noexcept {
+		while (first != last) {
+			const Node* next = first->next_node;
+			delete first;
+			first = next;
+		}
+	}
+
+	static const Node* CopyPrefix(const Node* source, size_t count, const Node* tail, const Node* shared) {
+		const Node* head = tail;
+		try {
+			std::vector<const Type*> prefix;
+			prefix.reserve(count);
+			for (const Node* node = source; count > 0; node = node->next_node, --count) {
+				prefix.push_back(&node->value);
+			}
+			for (auto it = prefix.rbegin(); it != prefix.rend(); ++it) {
+				head = new Node(**it, head);
+			}
+		}
+		catch (...) {
+			DeleteChain(head, shared);
+			throw;
+		}
+		return head;
+	}
+
+	ReaderSlot& LocalSlot() const {
+		thread_local LocalSlots local;
+		const SlotRegistry* registry = this->slots_.get();
+		for (const auto& entry : local.entries) {
+			if (entry.registry == registry) {
+				return *entry.slot;
+			}
+		}
+
+		local.entries.erase(std::remove_if(local.entries.begin(), local.entries.end(),
+			[](const auto& entry) { return entry.owner.expired(); }), local.entries.end());
+		local.entries.reserve(local.entries.size() + 1);
+		ReaderSlot* slot = ClaimSlot();
+		local.entries.push_back({ registry, this->slots_, slot });
+		return *slot;
+	}
+
+	// Takes a slot no live thread owns, or adds one. Runs once per thread and
+	// list; the push only retries while other threads are adding slots.
+	ReaderSlot* ClaimSlot() const {
+		std::atomic<ReaderSlot*>& head = this->slots_->head;
+		for (ReaderSlot* slot = head.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+			bool expected = false;
+			if (!slot->owned.load(std::memory_order_relaxed)
+				&& slot->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				return slot;
+			}
+		}
+
+		auto slot = std::make_unique<ReaderSlot>();
+		slot->owned.store(true, std::memory_order_relaxed);
+		slot->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(slot->next, slot.get(), std::memory_order_release, std::memory_order_relaxed)) {
+		}
+		return slot.release();
+	}
+
+	void Publish(const Version* version, size_t replaced_nodes) {
+		this->retired_.reserve(this->retired_.size() + 1);
+		const Version* old_version = this->current_.exchange(version, std::memory_order_seq_cst);
+		const uint64_t epoch = this->epoch_.fetch_add(1, std::memory_order_seq_cst);
+		this->retired_.push_back(Retired{ epoch, old_version, replaced_nodes });
+		ReclaimRetired();
+	}
+
+	void ReclaimRetired() {
+		uint64_t oldest_reader = std::numeric_limits<uint64_t>::max();
+		for (const ReaderSlot* slot = this->slots_->head.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+			const uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+			if (epoch != 0) {
+				oldest_reader = std::min(oldest_reader, epoch);
+			}
+		}
+
+		auto still_visible = std::partition(this->retired_.begin(), this->retired_.end(),
+			[oldest_reader](const Retired& retired) { return retired.epoch >= oldest_reader; });
+		std::for_each(still_visible, this->retired_.end(), [](const Retired& retired) { Free(retired); });
+		this->retired_.erase(still_visible, this->retired_.end());
+	}
+
+	static void Free(const Retired& retired) noexcept {
+		const Node* node = retired.version->head;
+		for (size_t i = 0; i < retired.node_count; ++i) {
+			const Node* next = node->next_node;
+			delete node;
+			node = next;
+		}
+		delete retired.version;
+	}
+};
+
+class WorkStealingScheduler {
+public:
+	using Task = std::function<void()>;
+
+	explicit WorkStealingScheduler(size_t worker_count)
+		: worker_count_(std::max<size_t>(worker_count, 1))
+		, workers_(new Worker[worker_count_]) {
+		for (size_t i = 0; i < this->worker_count_; ++i) {
+			this->workers_[i].thread = std::thread([this, i] { WorkerLoop(i); });
+		}
+	}
+
+	WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+	WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+	// An exception no Wait() has collected is dropped.
+	~WorkStealingScheduler() {
+		try {
+			Wait();
+		}
+		catch (...) {
+		}
+		{
+			std::lock_guard lock(this->mutex_);
+			this->stop_ = true;
+		}
+		this->work_cv_.notify_all();
+		for (size_t i = 0; i < this->worker_count_; ++i) {
+			this->workers_[i].thread.join();
+		}
+	}
+
+	[[nodiscard]] size_t GetWorkerCount() const noexcept {
+		return this->worker_count_;
+	}
+
+	void Submit(Task task) {
+		if (current_scheduler_ == this) {
+			this->pending_.fetch_add(1, std::memory_order_relaxed);
+			Worker& self = this->workers_[current_worker_];
+			self.tasks.PushFront(std::move(task));
+			self.has_work.store(true, std::memory_order_relaxed);
+			return;
+		}
+
+		{
+			std::lock_guard lock(this->mutex_);
+			this->pending_.fetch_add(1, std::memory_order_relaxed);
+			this->injected_.PushFront(std::move(task));
+			this->has_injected_.store(true, std::memory_order_release);
+		}
+		this->work_cv_.notify_all();
+	}
+
+	// Blocks until every submitted task has run. If any task threw, the first
+	// exception is rethrown here; the other tasks still run to completion.
+	void Wait() {
+		assert(current_scheduler_ != this);
+
+		std::unique_lock lock(this->mutex_);
+		this->done_cv_.wait(lock, [this] {
+			return this->pending_.load(std::memory_order_acquire) == 0;
+		});
+		if (this->error_) {
+			std::rethrow_exception(std::exchange(this->error_, nullptr));
+		}
+	}
+
+private:
+	static constexpr size_t kNoRequest = static_cast<size_t>(-1);
+	static constexpr size_t kStealPatience = 64;
+	// A steal hands over the older half of the victim's tasks, but the
+	// victim walks its list to find the split, so it keeps at most this many
+	// tasks and gives away the rest: a steal costs O(kMaxStealWalk), not
+	// O(queued tasks).
+	static constexpr size_t kMaxStealWalk = 256;
+
+	enum InboxState : int {
+		kInboxIdle,
+		kInboxWaiting,
+		kInboxFilled,
+		kInboxDeclined,
+	};
+
+	struct alignas(64) Worker {
+		SingleLinkedList<Task> tasks;
+		std::atomic<bool> has_work{ false };
+		std::atomic<size_t> steal_request{ kNoRequest };
+		std::atomic<int> inbox_state{ kInboxIdle };
+		SingleLinkedList<Task> inbox;
+		std::thread thread;
+	};
+
+	static inline thread_local WorkStealingScheduler* current_scheduler_ = nullptr;
+	static inline thread_local size_t current_worker_ = 0;
+
+	size_t worker_count_;
+	std::unique_ptr<Worker[]> workers_;
+	std::atomic<size_t> pending_{ 0 };
+	std::atomic<bool> has_injected_{ false };
+	SingleLinkedList<Task> injected_;
+	bool stop_ = false;
+	std::exception_ptr error_;
+	std::mutex mutex_;
+	std::condition_variable work_cv_;
+	std::condition_variable done_cv_;
+
+	void WorkerLoop(size_t index) {
+		current_scheduler_ = this;
+		current_worker_ = index;
+		Worker& self = this->workers_[index];
+
+		while (true) {
+			AnswerStealRequest(self);
+
+			if (!self.tasks.IsEmpty()) {
+				Task task = std::move(*self.tasks.begin());
+				self.tasks.PopFront();
+				self.has_work.store(!self.tasks.IsEmpty(), std::memory_order_relaxed);
+				try {
+					task();
+				}
+				catch (...) {
+					std::lock_guard lock(this->mutex_);
+					if (!this->error_) {
+						this->error_ = std::current_exception();
+					}
+				}
+				FinishTask();
+				continue;
+			}
+
+			if (TakeInjected(self) || TrySteal(index)) {
+				continue;
+			}
+
+			if (this->pending_.load(std::memory_order_acquire) != 0) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock lock(this->mutex_);
+			if (this->stop_) {
+				return;
+			}
+			this->work_cv_.wait(lock, [this] {
+				return this->stop_ || this->pending_.load(std::memory_order_relaxed) != 0;
+			});
+		}
+	}
+
+	void FinishTask() {
+		if (this->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard lock(this->mutex_);
+			this->done_cv_.notify_all();
+		}
+	}
+
+	bool TakeInjected(Worker& self) {
+		if (!this->has_injected_.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		std::lock_guard lock(this->mutex_);
+		if (this->injected_.IsEmpty()) {
+			return false;
+		}
+		self.tasks.swap(this->injected_);
+		this->has_injected_.store(false, std::memory_order_relaxed);
+		self.has_work.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	void AnswerStealRequest(Worker& self) {
+		if (self.steal_request.load(std::memory_order_relaxed) == kNoRequest) {
+			return;
+		}
+		const size_t thief = self.steal_request.exchange(kNoRequest, std::memory_order_acq_rel);
+		if (thief == kNoRequest) {
+			return;
+		}
+
+		Worker& receiver = this->workers_[thief];
+		const size_t size = self.tasks.GetSize();
+		if (size < 2) {
+			receiver.inbox_state.store(kInboxDeclined, std::memory_order_release);
+			return;
+		}
+
+		const size_t keep = std::min(size - size / 2, kMaxStealWalk);
+		auto last_kept = self.tasks.cbegin();
+		for (size_t i = 1; i < keep; ++i) {
+			++last_kept;
+		}
+		receiver.inbox = self.tasks.SplitAfter(last_kept, size - keep);
+		receiver.inbox_state.store(kInboxFilled, std::memory_order_release);
+	}
+
+	bool TrySteal(size_t index) {
+		Worker& self = this->workers_[index];
+
+		for (size_t attempt = 1; attempt < this->worker_count_; ++attempt) {
+			Worker& victim = this->workers_[(index + attempt) % this->worker_count_];
+			if (!victim.has_work.load(std::memory_order_relaxed)) {
+				continue;
+			}
+
+			self.inbox_state.store(kInboxWaiting, std::memory_order_relaxed);
+			size_t expected = kNoRequest;
+			if (!victim.steal_request.compare_exchange_strong(expected, index, std::memory_order_acq_rel)) {
+				continue;
+			}
+
+			int state = kInboxWaiting;
+			for (size_t spins = 0; (state = self.inbox_state.load(std::memory_order_acquire)) == kInboxWaiting; ++spins) {
+				AnswerStealRequest(self);
+				if (spins >= kStealPatience) {
+					expected = index;
+					if (victim.steal_request.compare_exchange_strong(expected, kNoRequest, std::memory_order_acq_rel)) {
+						state = kInboxDeclined;
+						break;
+					}
+				}
+				std::this_thread::yield();
+			}
+			self.inbox_state.store(kInboxIdle, std::memory_order_relaxed);
+
+			if (state == kInboxFilled) {
+				self.tasks = std::move(self.inbox);
+				self.has_work.store(true, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+};
@@ -0,0 +1,436 @@
+#pragma once
+
+#include "single_linked_list.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Read-only, array-backed form of a SingleLinkedList for lists that are built
+// once and then only iterated. Freeze() lays the values out contiguously so a
+// traversal streams through memory; Thaw() rebuilds a mutable list.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class FrozenList {
+	using ValueAllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+	using value_type = Type;
+	using allocator_type = Allocator;
+	using const_reference = const Type&;
+	using ConstIterator = const Type*;
+
+	explicit FrozenList(const Allocator& alloc = Allocator())
+		: alloc_(alloc) {}
+
+	template <typename SizePolicy>
+	explicit FrozenList(const SingleLinkedList<Type, Allocator, SizePolicy>& list)
+		: alloc_(ValueAllocatorTraits::select_on_container_copy_construction(list.get_allocator())) {
+		Fill(list.GetSize(), list.begin(), [](const Type& value) -> const Type& { return value; });
+	}
+
+	template <typename SizePolicy>
+	explicit FrozenList(SingleLinkedList<Type, Allocator, SizePolicy>&& list)
+		: alloc_(list.get_allocator()) {
+		Fill(list.GetSize(), list.begin(), [](auto&& value) -> decltype(auto) {
+			if constexpr (std::is_nothrow_move_constructible_v<Type>) {
+				return std::move(value);
+			}
+			else {
+				return std::as_const(value);
+			}
+		});
+		list.Clear();
+	}
+
+	FrozenList(const FrozenList& other)
+		: alloc_(ValueAllocatorTraits::select_on_container_copy_construction(other.alloc_)) {
+		Fill(other.size_, other.begin(), [](const Type& value) -> const Type& { return value; });
+	}
+
+	FrozenList(FrozenList&& other) noexcept
+		: alloc_(other.alloc_) {
+		this->swap(other);
+	}
+
+	~FrozenList() {
+		Release();
+	}
+
+	FrozenList& operator=(const FrozenList& rhs) {
+		if (this == &rhs) return *this;
+		FrozenList tmp_othrs(rhs);
+		this->swap(tmp_othrs);
+		return *this;
+	}
+
+	FrozenList& operator=(FrozenList&& rhs) noexcept {
+		if (this == &rhs) return *this;
+		Release();
+		this->swap(rhs);
+		return *this;
+	}
+
+	void swap(FrozenList& other) noexcept {
+		std::swap(this->data_, other.data_);
+		std::swap(this->size_, other.size_);
+		std::swap(this->alloc_, other.alloc_);
+	}
+
+	[[nodiscard]] ConstIterator begin() const noexcept {
+		return this->data_;
+	}
+
+	[[nodiscard]] ConstIterator end() const noexcept {
+		return this->data_ + this->size_;
+	}
+
+	[[nodiscard]] ConstIterator cbegin() const noexcept {
+		return this->data_;
+	}
+
+	[[nodiscard]] ConstIterator cend() const noexcept {
+		return this->data_ + this->size_;
+	}
+
+	[[nodiscard]] allocator_type get_allocator() const noexcept {
+		return this->alloc_;
+	}
+
+	[[nodiscard]] size_t GetSize() const noexcept {
+		return this->size_;
+	}
+
+	[[nodiscard]] bool IsEmpty() const noexcept {
+		return this->size_ == 0;
+	}
+
+	template <typename SizePolicy = TrackedSize>
+	[[nodiscard]] SingleLinkedList<Type, Allocator, SizePolicy> Thaw() const& {
+		SingleLinkedList<Type, Allocator, SizePolicy> list(this->alloc_);
+		auto pos = list.cbefore_begin();
+		for (const Type& value : *this) {
+			pos = list.InsertAfter(pos, value);
+		}
+		return list;
+	}
+
+	// Moves the values back into nodes (copies them if moving may throw) and
+	// leaves this frozen list empty. Every node is allocated before the first
+	// value is moved, so if that fails this frozen list is left untouched.
+	template <typename SizePolicy = TrackedSize>
+	[[nodiscard]] SingleLinkedList<Type, Allocator, SizePolicy> Thaw() && {
+		if constexpr (!std::is_nothrow_move_constructible_v<Type>) {
+			return std::as_const(*this).template Thaw<SizePolicy>();
+		}
+		else {
+			SingleLinkedList<Type, Allocator, SizePolicy> list(this->alloc_);
+			list.InsertAfter(list.cbefore_begin(), std::make_move_iterator(this->data_),
+				std::make_move_iterator(this->data_ + this->size_));
+			Release();
+			return list;
+		}
+	}
+
+private:
+	Type* data_ = nullptr;
+	size_t size_ = 0;
+	Allocator alloc_;
+
+	template <typename InputIt, typename Project>
+	void Fill(size_t count, InputIt first, Project project) {
+		if (count == 0) return;
+
+		Type* data = ValueAllocatorTraits::allocate(this->alloc_, count);
+		size_t constructed = 0;
+		try {
+			for (; constructed < count; ++constructed, ++first) {
+				ValueAllocatorTraits::construct(this->alloc_, data + constructed, project(*first));
+			}
+		}
+		catch (...) {
+			for (size_t i = 0; i < constructed; ++i) {
+				ValueAllocatorTraits::destroy(this->alloc_, data + i);
+			}
+			ValueAllocatorTraits::deallocate(this->alloc_, data, count);
+			throw;
+		}
+		this->data_ = data;
+		this->size_ = count;
+	}
+
+	void Release() noexcept {
+		if (this->data_ == nullptr) return;
+		for (size_t i = 0; i < this->size_; ++i) {
+			ValueAllocatorTraits::destroy(this->alloc_, this->data_ + i);
+		}
+		ValueAllocatorTraits::deallocate(this->alloc_, this->data_, this->size_);
+		this->data_ = nullptr;
+		this->size_ = 0;
+	}
+};
+
+// Frozen form of an integer list stored as zigzag-encoded deltas between
+// neighbours in LEB128 varints, so slowly changing sequences take about one
+// byte per element. Iteration decodes on the fly; ForEach and DecodeTo decode
+// in batches and take a fast path over runs of one-byte varints, found 16 (or,
+// without SSE2, 8) bytes at a time.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class CompressedFrozenList {
+	static_assert(std::is_integral_v<Type> && !std::is_same_v<Type, bool>, "delta coding needs an integer payload");
+
+	using Unsigned = std::make_unsigned_t<Type>;
+	using Signed = std::make_signed_t<Type>;
+	using ByteAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>;
+
+	// Zero bytes after the stream so the batch decoder may load a full lane
+	// past the last varint.
+	static constexpr size_t kPadding = 16;
+	static constexpr size_t kBatch = 64;
+
+public:
+	class ConstIterator {
+		friend class CompressedFrozenList;
+
+		ConstIterator(const uint8_t* next, size_t remaining)
+			: next_(next)
+			, remaining_(remaining) {
+			if (this->remaining_ != 0) {
+				Advance();
+			}
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Type*;
+		using reference = Type;
+
+		ConstIterator() = default;
+
+		[[nodiscard]] bool operator==(const ConstIterator& rhs) const noexcept {
+			return this->remaining_ == rhs.remaining_;
+		}
+
+		[[nodiscard]] bool operator!=(const ConstIterator& rhs) const noexcept {
+			return this->remaining_ != rhs.remaining_;
+		}
+
+		ConstIterator& operator++() noexcept {
+			if (--this->remaining_ != 0) {
+				Advance();
+			}
+			return *this;
+		}
+
+		ConstIterator operator++(int) noexcept {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		[[nodiscard]] reference operator*() const noexcept {
+			return this->value_;
+		}
+
+	private:
+		const uint8_t* next_ = nullptr;
+		size_t remaining_ = 0;
+		Type value_ = 0;
+
+		void Advance() noexcept {
+			this->value_ = Apply(this->value_, ReadVarint(this->next_));
+		}
+	};
+
+	using value_type = Type;
+	using allocator_type = Allocator;
+	using const_reference = Type;
+
+	explicit CompressedFrozenList(const Allocator& alloc = Allocator())
+		: bytes_(ByteAllocator(alloc)) {}
+
+	template <typename SizePolicy>
+	explicit CompressedFrozenList(const SingleLinkedList<Type, Allocator, SizePolicy>& list)
+		: bytes_(ByteAllocator(list.get_allocator())) {
+		this->bytes_.reserve(list.GetSize() + kPadding);
+		Type previous = 0;
+		for (Type value : list) {
+			WriteVarint(ZigZag(static_cast<Unsigned>(static_cast<Unsigned>(value) - static_cast<Unsigned>(previous))));
+			previous = value;
+		}
+		this->bytes_.resize(this->bytes_.size() + kPadding, 0);
+		this->bytes_.shrink_to_fit();
+		this->size_ = list.GetSize();
+	}
+
+	[[nodiscard]] ConstIterator begin() const noexcept {
+		return ConstIterator(this->bytes_.data(), this->size_);
+	}
+
+	[[nodiscard]] ConstIterator end() const noexcept {
+		return ConstIterator(nullptr, 0);
+	}
+
+	[[nodiscard]] ConstIterator cbegin() const noexcept {
+		return begin();
+	}
+
+	[[nodiscard]] ConstIterator cend() const noexcept {
+		return end();
+	}
+
+	[[nodiscard]] allocator_type get_allocator() const noexcept {
+		return allocator_type(this->bytes_.get_allocator());
+	}
+
+	[[nodiscard]] size_t GetSize() const noexcept {
+		return this->size_;
+	}
+
+	[[nodiscard]] bool IsEmpty() const noexcept {
+		return this->size_ == 0;
+	}
+
+	// Encoded bytes, not counting the decoder padding.
+	[[nodiscard]] size_t GetEncodedBytes() const noexcept {
+		return this->bytes_.size() - std::min(this->bytes_.size(), kPadding);
+	}
+
+	// Decodes all GetSize() values into out.
+	void DecodeTo(Type* out) const noexcept {
+		const uint8_t* next = this->bytes_.data();
+		Type previous = 0;
+		for (size_t done = 0; done < this->size_;) {
+			const size_t count = std::min(kBatch, this->size_ - done);
+			next = DecodeBatch(next, count, previous, out + done);
+			previous = out[done + count - 1];
+			done += count;
+		}
+	}
+
+	template <typename Func>
+	void ForEach(Func fn) const {
+		Type batch[kBatch];
+		const uint8_t* next = this->bytes_.data();
+		Type previous = 0;
+		for (size_t done = 0; done < this->size_;) {
+			const size_t count = std::min(kBatch, this->size_ - done);
+			next = DecodeBatch(next, count, previous, batch);
+			for (size_t i = 0; i < count; ++i) {
+				fn(batch[i]);
+			}
+			previous = batch[count - 1];
+			done += count;
+		}
+	}
+
+	template <typename SizePolicy = TrackedSize>
+	[[nodiscard]] SingleLinkedList<Type, Allocator, SizePolicy> Thaw() const {
+		SingleLinkedList<Type, Allocator, SizePolicy> list(get_allocator());
+		auto pos = list.cbefore_begin();
+		ForEach([&](Type value) {
+			pos = list.InsertAfter(pos, value);
+		});
+		return list;
+	}
+
+private:
+	std::vector<uint8_t, ByteAllocator> bytes_;
+	size_t size_ = 0;
+
+	[[nodiscard]] static Unsigned ZigZag(Unsigned delta) noexcept {
+		const auto sign = static_cast<Unsigned>(static_cast<Signed>(delta) < 0 ? ~Unsigned{ 0 } : 0);
+		return static_cast<Unsigned>(static_cast<Unsigned>(delta << 1) ^ sign);
+	}
+
+	[[nodiscard]] static Type Apply(Type previous, Unsigned zigzag) noexcept {
+		const auto delta = static_cast<Unsigned>((zigzag >> 1) ^ static_cast<Unsigned>(0 - (zigzag & 1)));
+		return static_cast<Type>(static_cast<Unsigned>(static_cast<Unsigned>(previous) + delta));
+	}
+
+	void WriteVarint(Unsigned value) {
+		while (value >= 0x80) {
+			this->bytes_.push_back(static_cast<uint8_t>((value & 0x7f) | 0x80));
+			value = static_cast<Unsigned>(value >> 7);
+		}
+		this->bytes_.push_back(static_cast<uint8_t>(value));
+	}
+
+	[[nodiscard]] static Unsigned ReadVarint(const uint8_t*& next) noexcept {
+		Unsigned value = 0;
+		for (unsigned shift = 0;; shift += 7) {
+			const uint8_t byte = *next++;
+			value = static_cast<Unsigned>(value | static_cast<Unsigned>(static_cast<Unsigned>(byte & 0x7f) << shift));
+			if ((byte & 0x80) == 0) {
+				return value;
+			}
+		}
+	}
+
+	// Number of leading one-byte varints among the next lane of bytes.
+	[[nodiscard]] static size_t ShortVarintRun(const uint8_t* next) noexcept {
+#if defined(__SSE2__)
+		const __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(next));
+		const auto continuation = static_cast<uint32_t>(_mm_movemask_epi8(lane));
+		return continuation == 0 ? 16 : static_cast<size_t>(__builtin_ctz(continuation));
+#else
+		uint64_t word;
+		std::memcpy(&word, next, sizeof(word));
+		const uint64_t continuation = word & 0x8080808080808080ULL;
+		if (continuation == 0) {
+			return 8;
+		}
+		size_t run = 0;
+		while ((continuation >> (8 * run + 7) & 1) == 0) {
+			++run;
+		}
+		return run;
+#endif
+	}
+
+	static const uint8_t* DecodeBatch(const uint8_t* next, size_t count, Type previous, Type* out) noexcept {
+		size_t i = 0;
+		while (i < count) {
+			const size_t run = std::min(ShortVarintRun(next), count - i);
+			for (size_t j = 0; j < run; ++j) {
+				previous = Apply(previous, next[j]);
+				out[i + j] = previous;
+			}
+			next += run;
+			i += run;
+			if (i < count && run == 0) {
+				previous = Apply(previous, ReadVarint(next));
+				out[i++] = previous;
+			}
+		}
+		return next;
+	}
+};
+
+template <typename Type, typename Allocator, typename SizePolicy>
+[[nodiscard]] FrozenList<Type, Allocator> Freeze(const SingleLinkedList<Type, Allocator, SizePolicy>& list) {
+	return FrozenList<Type, Allocator>(list);
+}
+
+// Moves the values out of the list, which is left empty.
+template <typename Type, typename Allocator, typename SizePolicy>
+[[nodiscard]] FrozenList<Type, Allocator> Freeze(SingleLinkedList<Type, Allocator, SizePolicy>&& list) {
+	return FrozenList<Type, Allocator>(std::move(list));
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+[[nodiscard]] CompressedFrozenList<Type, Allocator> FreezeCompressed(const SingleLinkedList<Type, Allocator, SizePolicy>& list) {
+	return CompressedFrozenList<Type, Allocator>(list);
+}
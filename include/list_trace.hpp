@@ -0,0 +1,256 @@
+#pragma once
+
+#include "single_linked_list.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class TraceOperation : uint8_t {
+	kPushFront = 1,
+	kPopFront = 2,
+	kInsertAfter = 3,
+	kEraseAfter = 4,
+	kIterate = 5,
+	kClear = 6,
+};
+
+struct TraceRecord {
+	TraceOperation operation;
+	size_t position = 0;
+
+	[[nodiscard]] bool operator==(const TraceRecord& rhs) const noexcept {
+		return this->operation == rhs.operation && this->position == rhs.position;
+	}
+};
+
+class TraceWriter {
+public:
+	explicit TraceWriter(std::ostream& output)
+		: output_(output) {
+		this->output_.write(kMagic, sizeof(kMagic));
+	}
+
+	void Write(TraceOperation operation, size_t position = 0) {
+		this->output_.put(static_cast<char>(operation));
+		if (operation == TraceOperation::kInsertAfter || operation == TraceOperation::kEraseAfter) {
+			for (uint64_t value = position; ; value >>= 7) {
+				if (value < 0x80) {
+					this->output_.put(static_cast<char>(value));
+					break;
+				}
+				this->output_.put(static_cast<char>((value & 0x7f) | 0x80));
+			}
+		}
+	}
+
+	static constexpr char kMagic[4] = { 'S', 'L', 'T', '1' };
+
+private:
+	std::ostream& output_;
+};
+
+class TraceReader {
+public:
+	explicit TraceReader(std::istream& input)
+		: input_(input) {
+		char magic[sizeof(TraceWriter::kMagic)] = {};
+		if (!this->input_.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(TraceWriter::kMagic))) {
+			throw std::runtime_error("not a SingleLinkedList trace");
+		}
+	}
+
+	std::optional<TraceRecord> Next() {
+		const int operation = this->input_.get();
+		if (operation == std::char_traits<char>::eof()) {
+			return std::nullopt;
+		}
+		if (operation < static_cast<int>(TraceOperation::kPushFront) || operation > static_cast<int>(TraceOperation::kClear)) {
+			throw std::runtime_error("corrupted trace: unknown operation");
+		}
+
+		TraceRecord record{ static_cast<TraceOperation>(operation) };
+		if (record.operation == TraceOperation::kInsertAfter || record.operation == TraceOperation::kEraseAfter) {
+			uint64_t value = 0;
+			for (int shift = 0; ; shift += 7) {
+				const int byte = this->input_.get();
+				if (byte == std::char_traits<char>::eof() || shift > 63) {
+					throw std::runtime_error("corrupted trace: truncated position");
+				}
+				value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if ((byte & 0x80) == 0) {
+					break;
+				}
+			}
+			record.position = static_cast<size_t>(value);
+		}
+		return record;
+	}
+
+	std::vector<TraceRecord> ReadAll() {
+		std::vector<TraceRecord> records;
+		while (auto record = Next()) {
+			records.push_back(*record);
+		}
+		return records;
+	}
+
+private:
+	std::istream& input_;
+};
+
+template <typename Type, typename Allocator = std::allocator<Type>>
+class TracingList {
+public:
+	using List = SingleLinkedList<Type, Allocator>;
+
+	class Position {
+		friend class TracingList;
+
+		Position(typename List::ConstIterator it, size_t index, size_t generation)
+			: it_(it)
+			, index_(index)
+			, generation_(generation) {}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Type*;
+		using reference = const Type&;
+
+		Position() = default;
+
+		[[nodiscard]] bool operator==(const Position& rhs) const noexcept {
+			return this->it_ == rhs.it_;
+		}
+
+		[[nodiscard]] bool operator!=(const Position& rhs) const noexcept {
+			return this->it_ != rhs.it_;
+		}
+
+		Position& operator++() noexcept {
+			++this->it_;
+			++this->index_;
+			return *this;
+		}
+
+		Position operator++(int) noexcept {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		[[nodiscard]] reference operator*() const noexcept {
+			return *this->it_;
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept {
+			return &*this->it_;
+		}
+
+	private:
+		typename List::ConstIterator it_;
+		// index_ is only trusted while generation_ matches the list's: any
+		// mutation can shift the positions after it.
+		size_t index_ = 0;
+		size_t generation_ = 0;
+	};
+
+	explicit TracingList(TraceWriter& writer, const Allocator& alloc = Allocator())
+		: writer_(writer)
+		, list_(alloc) {}
+
+	[[nodiscard]] Position before_begin() const noexcept {
+		return Position(this->list_.cbefore_begin(), 0, this->generation_);
+	}
+
+	[[nodiscard]] Position begin() const noexcept {
+		return Position(this->list_.cbegin(), 1, this->generation_);
+	}
+
+	[[nodiscard]] Position end() const noexcept {
+		return Position(this->list_.cend(), this->list_.GetSize() + 1, this->generation_);
+	}
+
+	[[nodiscard]] size_t GetSize() const noexcept {
+		return this->list_.GetSize();
+	}
+
+	[[nodiscard]] bool IsEmpty() const noexcept {
+		return this->list_.IsEmpty();
+	}
+
+	[[nodiscard]] const List& GetList() const noexcept {
+		return this->list_;
+	}
+
+	// Index of pos in the list as it is now, before_begin() being 0. O(1) for
+	// a position obtained since the last mutation, a walk from the head for
+	// an older one.
+	[[nodiscard]] size_t IndexOf(const Position& pos) const noexcept {
+		if (pos.generation_ == this->generation_) {
+			return pos.index_;
+		}
+		size_t index = 0;
+		for (auto it = this->list_.cbefore_begin(); it != pos.it_; ++it) {
+			++index;
+		}
+		return index;
+	}
+
+	void PushFront(const Type& value) {
+		this->list_.PushFront(value);
+		++this->generation_;
+		this->writer_.Write(TraceOperation::kPushFront);
+	}
+
+	void PopFront() {
+		this->list_.PopFront();
+		++this->generation_;
+		this->writer_.Write(TraceOperation::kPopFront);
+	}
+
+	Position InsertAfter(Position pos, const Type& value) {
+		const size_t index = IndexOf(pos);
+		auto it = this->list_.InsertAfter(pos.it_, value);
+		++this->generation_;
+		this->writer_.Write(TraceOperation::kInsertAfter, index);
+		return Position(it, index + 1, this->generation_);
+	}
+
+	Position EraseAfter(Position pos) {
+		const size_t index = IndexOf(pos);
+		auto it = this->list_.EraseAfter(pos.it_);
+		++this->generation_;
+		this->writer_.Write(TraceOperation::kEraseAfter, index);
+		return Position(it, index + 1, this->generation_);
+	}
+
+	void Clear() {
+		this->list_.Clear();
+		++this->generation_;
+		this->writer_.Write(TraceOperation::kClear);
+	}
+
+	template <typename Func>
+	void ForEach(Func fn) const {
+		for (const Type& value : this->list_) {
+			fn(value);
+		}
+		this->writer_.Write(TraceOperation::kIterate);
+	}
+
+private:
+	TraceWriter& writer_;
+	List list_;
+	size_t generation_ = 0;
+};
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+class NodeCache {
+public:
+	static constexpr size_t kAlignment = alignof(std::max_align_t);
+	static constexpr size_t kMaxBlockSize = 256;
+	static constexpr size_t kClassCount = kMaxBlockSize / kAlignment;
+	static constexpr size_t kMagazineSize = 64;
+	static constexpr size_t kMaxDepotMagazines = 64;
+
+	[[nodiscard]] static constexpr bool IsCached(size_t bytes, size_t alignment) noexcept {
+		return bytes != 0 && bytes <= kMaxBlockSize && alignment <= kAlignment;
+	}
+
+	// Once the calling thread's cache has been destroyed (a thread_local or
+	// static list outliving it at thread or program exit), blocks go straight
+	// to the global heap.
+	[[nodiscard]] static void* Allocate(size_t bytes) {
+		assert(IsCached(bytes, 1));
+		if (LocalCacheDestroyed()) {
+			return ::operator new(ClassSize(ClassIndex(bytes)));
+		}
+		return LocalCache().Allocate(ClassIndex(bytes));
+	}
+
+	static void Deallocate(void* block, size_t bytes) noexcept {
+		assert(IsCached(bytes, 1));
+		if (LocalCacheDestroyed()) {
+			::operator delete(block);
+			return;
+		}
+		LocalCache().Deallocate(block, ClassIndex(bytes));
+	}
+
+private:
+	struct Magazine {
+		size_t count = 0;
+		void* blocks[kMagazineSize];
+	};
+
+	class Depot {
+	public:
+		~Depot() {
+			DepotDestroyed() = true;
+			for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+				for (Magazine* magazine : this->full_[size_class]) {
+					ReleaseMagazine(magazine);
+				}
+			}
+		}
+
+		Magazine* TakeFull(size_t size_class) noexcept {
+			if (DepotDestroyed()) {
+				return nullptr;
+			}
+			std::lock_guard lock(this->mutex_);
+			auto& magazines = this->full_[size_class];
+			if (magazines.empty()) {
+				return nullptr;
+			}
+			Magazine* magazine = magazines.back();
+			magazines.pop_back();
+			return magazine;
+		}
+
+		bool PutFull(size_t size_class, Magazine* magazine) noexcept {
+			if (DepotDestroyed()) {
+				return false;
+			}
+			std::lock_guard lock(this->mutex_);
+			auto& magazines = this->full_[size_class];
+			if (magazines.size() >= kMaxDepotMagazines) {
+				return false;
+			}
+			magazines.push_back(magazine);
+			return true;
+		}
+
+	private:
+		std::mutex mutex_;
+		std::vector<Magazine*> full_[kClassCount];
+	};
+
+	class ThreadCache {
+	public:
+		~ThreadCache() {
+			LocalCacheDestroyed() = true;
+			for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+				Retire(size_class, this->loaded_[size_class]);
+				Retire(size_class, this->previous_[size_class]);
+				this->loaded_[size_class] = nullptr;
+				this->previous_[size_class] = nullptr;
+			}
+		}
+
+		void* Allocate(size_t size_class) {
+			Magazine*& loaded = this->loaded_[size_class];
+			Magazine*& previous = this->previous_[size_class];
+			if (loaded != nullptr && loaded->count > 0) {
+				return loaded->blocks[--loaded->count];
+			}
+			if (previous != nullptr && previous->count > 0) {
+				std::swap(loaded, previous);
+				return loaded->blocks[--loaded->count];
+			}
+			if (Magazine* full = GetDepot().TakeFull(size_class)) {
+				delete loaded;
+				loaded = full;
+				return loaded->blocks[--loaded->count];
+			}
+			return ::operator new(ClassSize(size_class));
+		}
+
+		void Deallocate(void* block, size_t size_class) noexcept {
+			Magazine*& loaded = this->loaded_[size_class];
+			Magazine*& previous = this->previous_[size_class];
+			if (loaded != nullptr && loaded->count < kMagazineSize) {
+				loaded->blocks[loaded->count++] = block;
+				return;
+			}
+			if (previous != nullptr && previous->count < kMagazineSize) {
+				std::swap(loaded, previous);
+				loaded->blocks[loaded->count++] = block;
+				return;
+			}
+
+			Magazine* empty = new (std::nothrow) Magazine();
+			if (empty == nullptr) {
+				::operator delete(block);
+				return;
+			}
+			if (previous != nullptr) {
+				Retire(size_class, previous);
+			}
+			previous = loaded;
+			loaded = empty;
+			loaded->blocks[loaded->count++] = block;
+		}
+
+	private:
+		Magazine* loaded_[kClassCount] = {};
+		Magazine* previous_[kClassCount] = {};
+
+		static void Retire(size_t size_class, Magazine* magazine) noexcept {
+			if (magazine == nullptr) {
+				return;
+			}
+			if (magazine->count == kMagazineSize && GetDepot().PutFull(size_class, magazine)) {
+				return;
+			}
+			ReleaseMagazine(magazine);
+		}
+	};
+
+	[[nodiscard]] static constexpr size_t ClassIndex(size_t bytes) noexcept {
+		return (bytes + kAlignment - 1) / kAlignment - 1;
+	}
+
+	[[nodiscard]] static constexpr size_t ClassSize(size_t size_class) noexcept {
+		return (size_class + 1) * kAlignment;
+	}
+
+	static void ReleaseMagazine(Magazine* magazine) noexcept {
+		for (size_t i = 0; i < magazine->count; ++i) {
+			::operator delete(magazine->blocks[i]);
+		}
+		delete magazine;
+	}
+
+	// Trivially destructible flags, so they stay readable after the objects
+	// they describe are gone.
+	static bool& DepotDestroyed() noexcept {
+		static bool destroyed = false;
+		return destroyed;
+	}
+
+	static bool& LocalCacheDestroyed() noexcept {
+		thread_local bool destroyed = false;
+		return destroyed;
+	}
+
+	static Depot& GetDepot() noexcept {
+		static Depot depot;
+		return depot;
+	}
+
+	static ThreadCache& LocalCache() noexcept {
+		GetDepot();
+		thread_local ThreadCache cache;
+		return cache;
+	}
+};
+
+template <typename Type>
+class NodeCacheAllocator {
+public:
+	using value_type = Type;
+
+	NodeCacheAllocator() noexcept = default;
+
+	template <typename Other>
+	NodeCacheAllocator(const NodeCacheAllocator<Other>&) noexcept {}
+
+	[[nodiscard]] Type* allocate(size_t count) {
+		if (count == 1 && NodeCache::IsCached(sizeof(Type), alignof(Type))) {
+			return static_cast<Type*>(NodeCache::Allocate(sizeof(Type)));
+		}
+		return std::allocator<Type>().allocate(count);
+	}
+
+	void deallocate(Type* pointer, size_t count) noexcept {
+		if (count == 1 && NodeCache::IsCached(sizeof(Type), alignof(Type))) {
+			NodeCache::Deallocate(pointer, sizeof(Type));
+			return;
+		}
+		std::allocator<Type>().deallocate(pointer, count);
+	}
+};
+
+template <typename Lhs, typename Rhs>
+bool operator==(const NodeCacheAllocator<Lhs>&, const NodeCacheAllocator<Rhs>&) noexcept {
+	return true;
+}
+
+template <typename Lhs, typename Rhs>
+bool operator!=(const NodeCacheAllocator<Lhs>&, const NodeCacheAllocator<Rhs>&) noexcept {
+	return false;
+}
+
+enum class HugePages {
+	kNone,
+	kTransparent,
+	kExplicit,
+};
+
+class NodeArena {
+public:
+	static constexpr size_t kHugePageSize = size_t{ 2 } << 20;
+	static constexpr size_t kAlignment = alignof(std::max_align_t);
+	static constexpr size_t kClassCount = 16;
+
+	explicit NodeArena(HugePages huge_pages = HugePages::kTransparent, size_t region_size = size_t{ 64 } << 20)
+		: requested_(huge_pages)
+		, region_size_(std::max(RoundUp(region_size, kHugePageSize), kHugePageSize)) {}
+
+	NodeArena(const NodeArena&) = delete;
+	NodeArena& operator=(const NodeArena&) = delete;
+
+	~NodeArena() {
+		for (const Region& region : this->regions_) {
+			ReleaseRegion(region);
+		}
+	}
+
+	[[nodiscard]] HugePages GetRequestedHugePages() const noexcept {
+		return this->requested_;
+	}
+
+	[[nodiscard]] HugePages GetHugePages() const noexcept {
+		return this->obtained_;
+	}
+
+	[[nodiscard]] size_t GetReservedBytes() const noexcept {
+		return this->regions_.size() * this->region_size_;
+	}
+
+	[[nodiscard]] void* Allocate(size_t bytes, [[maybe_unused]] size_t alignment) {
+		assert(alignment <= kAlignment);
+		bytes = RoundUp(std::max<size_t>(bytes, 1), kAlignment);
+
+		const size_t size_class = bytes / kAlignment - 1;
+		if (size_class < kClassCount && this->free_lists_[size_class] != nullptr) {
+			FreeBlock* block = this->free_lists_[size_class];
+			this->free_lists_[size_class] = block->next;
+			return block;
+		}
+
+		if (bytes > static_cast<size_t>(this->end_ - this->cursor_)) {
+			if (bytes > this->region_size_) {
+				throw std::bad_alloc();
+			}
+			AddRegion();
+		}
+		void* block = this->cursor_;
+		this->cursor_ += bytes;
+		return block;
+	}
+
+	void Deallocate(void* pointer, size_t bytes) noexcept {
+		bytes = RoundUp(std::max<size_t>(bytes, 1), kAlignment);
+		const size_t size_class = bytes / kAlignment - 1;
+		if (size_class < kClassCount) {
+			this->free_lists_[size_class] = new (pointer) FreeBlock{ this->free_lists_[size_class] };
+		}
+	}
+
+private:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	// mapping and mapped_size describe what is released; blocks are carved
+	// from base, which is mapping rounded up to kHugePageSize.
+	struct Region {
+		void* mapping;
+		size_t mapped_size;
+		void* base;
+		bool mapped;
+	};
+
+	HugePages requested_;
+	HugePages obtained_ = HugePages::kNone;
+	size_t region_size_;
+	std::vector<Region> regions_;
+	char* cursor_ = nullptr;
+	char* end_ = nullptr;
+	FreeBlock* free_lists_[kClassCount] = {};
+
+	[[nodiscard]] static constexpr size_t RoundUp(size_t value, size_t alignment) noexcept {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	void AddRegion() {
+		this->regions_.reserve(this->regions_.size() + 1);
+		Region region = MapRegion();
+		this->regions_.push_back(region);
+		this->cursor_ = static_cast<char*>(region.base);
+		this->end_ = this->cursor_ + this->region_size_;
+	}
+
+	Region MapRegion() {
+#if defined(__linux__)
+		if (this->requested_ == HugePages::kExplicit) {
+			void* base = mmap(nullptr, this->region_size_, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (base != MAP_FAILED) {
+				this->obtained_ = HugePages::kExplicit;
+				return Region{ base, this->region_size_, base, true };
+			}
+		}
+
+		const size_t mapped_size = this->region_size_ + kHugePageSize;
+		void* mapping = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (mapping != MAP_FAILED) {
+			void* base = reinterpret_cast<void*>(RoundUp(reinterpret_cast<uintptr_t>(mapping), kHugePageSize));
+			if (this->requested_ != HugePages::kNone && madvise(base, this->region_size_, MADV_HUGEPAGE) == 0) {
+				if (this->obtained_ == HugePages::kNone) {
+					this->obtained_ = HugePages::kTransparent;
+				}
+			}
+			return Region{ mapping, mapped_size, base, true };
+		}
+#endif
+		void* base = ::operator new(this->region_size_, std::align_val_t{ kHugePageSize });
+		return Region{ base, this->region_size_, base, false };
+	}
+
+	void ReleaseRegion(const Region& region) noexcept {
+#if defined(__linux__)
+		if (region.mapped) {
+			munmap(region.mapping, region.mapped_size);
+			return;
+		}
+#endif
+		::operator delete(region.mapping, std::align_val_t{ kHugePageSize });
+	}
+};
+
+template <typename Type>
+class ArenaAllocator {
+	template <typename Other>
+	friend class ArenaAllocator;
+
+public:
+	using value_type = Type;
+
+	explicit ArenaAllocator(NodeArena& arena) noexcept
+		: arena_(&arena) {}
+
+	template <typename Other>
+	ArenaAllocator(const ArenaAllocator<Other>& other) noexcept
+		: arena_(other.arena_) {}
+
+	[[nodiscard]] Type* allocate(size_t count) {
+		return static_cast<Type*>(this->arena_->Allocate(count * sizeof(Type), alignof(Type)));
+	}
+
+	void deallocate(Type* pointer, size_t count) noexcept {
+		this->arena_->Deallocate(pointer, count * sizeof(Type));
+	}
+
+	[[nodiscard]] NodeArena& GetArena() const noexcept {
+		return *this->arena_;
+	}
+
+	template <typename Other>
+	[[nodiscard]] bool operator==(const ArenaAllocator<Other>& rhs) const noexcept {
+		return this->arena_ == rhs.arena_;
+	}
+
+	template <typename Other>
+	[[nodiscard]] bool operator!=(const ArenaAllocator<Other>& rhs) const noexcept {
+		return this->arena_ != rhs.arena_;
+	}
+
+private:
+	NodeArena* arena_;
+};
+
+struct AllocationStats {
+	size_t allocations = 0;
+	size_t deallocations = 0;
+	size_t bytes_allocated = 0;
+	size_t bytes_deallocated = 0;
+};
+
+inline AllocationStats operator-(const AllocationStats& lhs, const AllocationStats& rhs) noexcept {
+	return AllocationStats{
+		lhs.allocations - rhs.allocations,
+		lhs.deallocations - rhs.deallocations,
+		lhs.bytes_allocated - rhs.bytes_allocated,
+		lhs.bytes_deallocated - rhs.bytes_deallocated,
+	};
+}
+
+template <typename Type>
+class CountingAllocator {
+	template <typename Other>
+	friend class CountingAllocator;
+
+public:
+	using value_type = Type;
+
+	explicit CountingAllocator(AllocationStats& stats) noexcept
+		: stats_(&stats) {}
+
+	template <typename Other>
+	CountingAllocator(const CountingAllocator<Other>& other) noexcept
+		: stats_(other.stats_) {}
+
+	[[nodiscard]] Type* allocate(size_t count) {
+		Type* pointer = std::allocator<Type>().allocate(count);
+		++this->stats_->allocations;
+		this->stats_->bytes_allocated += count * sizeof(Type);
+		return pointer;
+	}
+
+	void deallocate(Type* pointer, size_t count) noexcept {
+		++this->stats_->deallocations;
+		this->stats_->bytes_deallocated += count * sizeof(Type);
+		std::allocator<Type>().deallocate(pointer, count);
+	}
+
+	[[nodiscard]] const AllocationStats& GetStats() const noexcept {
+		return *this->stats_;
+	}
+
+	template <typename Other>
+	[[nodiscard]] bool operator==(const CountingAllocator<Other>& rhs) const noexcept {
+		return this->stats_ == rhs.stats_;
+	}
+
+	template <typename Other>
+	[[nodiscard]] bool operator!=(const CountingAllocator<Other>& rhs) const noexcept {
+		return this->stats_ != rhs.stats_;
+	}
+
+private:
+	AllocationStats* stats_;
+};
@@ -0,0 +1,626 @@
+#pragma once
+
+#include "single_linked_list.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+template <typename Type>
+struct PackedElement;
+
+template <>
+struct PackedElement<bool> {
+	static constexpr unsigned kBits = 1;
+};
+
+template <>
+struct PackedElement<uint8_t> {
+	static constexpr unsigned kBits = 8;
+};
+
+// Unrolled, bit-packed list of bool or uint8_t, opted into in place of
+// SingleLinkedList where the element density matters more than the full
+// SingleLinkedList API. Elements live in 64-byte blocks of six words, so
+// a block holds 384 bools or 48 bytes. Iterators are (block, index) pairs and
+// mutable ones dereference to a proxy, as std::vector<bool> does. InsertAfter
+// and EraseAfter shift the tail of the affected block and so invalidate
+// iterators past the position within that block; iterators into other blocks
+// stay valid. Erasing never merges blocks, Compact() repacks them.
+template <typename Type, typename Allocator = std::allocator<Type>, typename SizePolicy = TrackedSize>
+class PackedSingleLinkedList {
+	using Word = uint64_t;
+
+	static constexpr size_t kBits = PackedElement<Type>::kBits;
+	static constexpr size_t kWordBits = 64;
+	static constexpr size_t kPerWord = kWordBits / kBits;
+	static constexpr size_t kWordsPerBlock = 6;
+	static constexpr size_t kCapacity = kWordsPerBlock * kPerWord;
+	static constexpr Word kElementMask = (Word{ 1 } << kBits) - 1;
+
+	struct BlockBase {
+		BlockBase* next = nullptr;
+		uint32_t count = 0;
+	};
+
+	struct Block : BlockBase {
+		Word words[kWordsPerBlock];
+	};
+
+	static_assert(kWordsPerBlock % 2 == 0, "full blocks split on a word boundary");
+	static_assert(sizeof(Block) == 64, "a block should fill one cache line");
+
+	using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+	using BlockAllocatorTraits = std::allocator_traits<BlockAllocator>;
+
+public:
+	class Reference {
+		friend class PackedSingleLinkedList;
+
+		Reference(Block* block, size_t index) noexcept
+			: block_(block)
+			, index_(index) {}
+
+	public:
+		Reference(const Reference&) = default;
+
+		operator Type() const noexcept {
+			return Get(this->block_->words, this->index_);
+		}
+
+		Reference& operator=(Type value) noexcept {
+			Set(this->block_->words, this->index_, value);
+			return *this;
+		}
+
+		Reference& operator=(const Reference& rhs) noexcept {
+			return *this = static_cast<Type>(rhs);
+		}
+
+		void Flip() noexcept {
+			Set(this->block_->words, this->index_, static_cast<Type>(Get(this->block_->words, this->index_) ^ kElementMask));
+		}
+
+	private:
+		Block* block_;
+		size_t index_;
+	};
+
+private:
+	template <typename ValueType>
+	class BasicIterator {
+		friend class PackedSingleLinkedList;
+
+		static constexpr bool kIsConst = std::is_const_v<ValueType>;
+
+		BasicIterator(BlockBase* block, size_t index)
+			: block_(block)
+			, index_(index) {}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::conditional_t<kIsConst, Type, Reference>;
+
+		BasicIterator() = default;
+
+		BasicIterator(const BasicIterator<Type>& other) noexcept
+			: block_(other.block_)
+			, index_(other.index_) {}
+
+		BasicIterator& operator=(const BasicIterator& rhs) = default;
+
+		template <typename OtherType>
+		[[nodiscard]] bool operator==(const BasicIterator<OtherType>& rhs) const noexcept {
+			return this->block_ == rhs.block_ && this->index_ == rhs.index_;
+		}
+
+		template <typename OtherType>
+		[[nodiscard]] bool operator!=(const BasicIterator<OtherType>& rhs) const noexcept {
+			return !(*this == rhs);
+		}
+
+		BasicIterator& operator++() noexcept {
+			if (++this->index_ == this->block_->count) {
+				this->block_ = this->block_->next;
+				this->index_ = 0;
+			}
+			return *this;
+		}
+
+		BasicIterator operator++(int) noexcept {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		[[nodiscard]] reference operator*() const noexcept {
+			if constexpr (kIsConst) {
+				return Get(static_cast<const Block*>(this->block_)->words, this->index_);
+			}
+			else {
+				return Reference(static_cast<Block*>(this->block_), this->index_);
+			}
+		}
+
+	private:
+		template <typename OtherType>
+		friend class BasicIterator;
+
+		BlockBase* block_ = nullptr;
+		size_t index_ = 0;
+	};
+
+public:
+	using value_type = Type;
+	using allocator_type = Allocator;
+	using size_policy = SizePolicy;
+	using reference = Reference;
+	using const_reference = Type;
+
+	using Iterator = BasicIterator<Type>;
+	using ConstIterator = BasicIterator<const Type>;
+
+	[[nodiscard]] Iterator begin() noexcept {
+		return Iterator(this->header_.head.next, 0);
+	}
+
+	[[nodiscard]] Iterator end() noexcept {
+		return Iterator(nullptr, 0);
+	}
+
+	[[nodiscard]] ConstIterator begin() const noexcept {
+		return ConstIterator(this->header_.head.next, 0);
+	}
+
+	[[nodiscard]] ConstIterator end() const noexcept {
+		return ConstIterator(nullptr, 0);
+	}
+
+	[[nodiscard]] ConstIterator cbegin() const noexcept {
+		return ConstIterator(this->header_.head.next, 0);
+	}
+
+	[[nodiscard]] ConstIterator cend() const noexcept {
+		return ConstIterator(nullptr, 0);
+	}
+
+	[[nodiscard]] Iterator before_begin() noexcept {
+		return Iterator(&this->header_.head, 0);
+	}
+
+	[[nodiscard]] ConstIterator cbefore_begin() const noexcept {
+		return ConstIterator(const_cast<BlockBase*>(&this->header_.head), 0);
+	}
+
+	[[nodiscard]] ConstIterator before_begin() const noexcept {
+		return ConstIterator(const_cast<BlockBase*>(&this->header_.head), 0);
+	}
+
+	PackedSingleLinkedList() = default;
+
+	explicit PackedSingleLinkedList(const Allocator& alloc)
+		: header_(BlockAllocator(alloc)) {}
+
+	PackedSingleLinkedList(std::initializer_list<Type> values, const Allocator& alloc = Allocator())
+		: header_(BlockAllocator(alloc)) {
+		PackedSingleLinkedList tmp(alloc);
+		ConstIterator pos = tmp.cbefore_begin();
+		for (Type value : values) {
+			pos = tmp.InsertAfter(pos, value);
+		}
+		this->swap(tmp);
+	}
+
+	PackedSingleLinkedList(const PackedSingleLinkedList& other)
+		: header_(BlockAllocatorTraits::select_on_container_copy_construction(other.header_.Alloc())) {
+		PackedSingleLinkedList tmp(this->get_allocator());
+		BlockBase* last = &tmp.header_.head;
+		for (const BlockBase* base = other.header_.head.next; base != nullptr; base = base->next) {
+			Block* block = tmp.CreateBlock(nullptr);
+			std::memcpy(block->words, static_cast<const Block*>(base)->words, sizeof(block->words));
+			block->count = base->count;
+			last->next = block;
+			last = block;
+			tmp.header_.Add(base->count);
+		}
+		this->swap(tmp);
+	}
+
+	PackedSingleLinkedList(PackedSingleLinkedList&& other) noexcept
+		: header_(other.header_.Alloc()) {
+		this->swap(other);
+	}
+
+	~PackedSingleLinkedList() {
+		Clear();
+	}
+
+	[[nodiscard]] allocator_type get_allocator() const noexcept {
+		return allocator_type(this->header_.Alloc());
+	}
+
+	// O(1) under TrackedSize, O(blocks) under UntrackedSize.
+	[[nodiscard]] size_t GetSize() const noexcept {
+		if constexpr (SizePolicy::kIsTracked) {
+			return this->header_.size;
+		}
+		else {
+			return CountFrom(this->header_.head.next);
+		}
+	}
+
+	[[nodiscard]] bool IsEmpty() const noexcept {
+		return this->header_.head.next == nullptr;
+	}
+
+	void PushFront(Type value) {
+		InsertAfter(this->cbefore_begin(), value);
+	}
+
+	void Clear() noexcept {
+		while (this->header_.head.next != nullptr) {
+			BlockBase* block = this->header_.head.next;
+			this->header_.head.next = block->next;
+			this->header_.Subtract(block->count);
+			DestroyBlock(block);
+		}
+	}
+
+	PackedSingleLinkedList& operator=(const PackedSingleLinkedList& rhs) {
+		if (this == &rhs) return *this;
+		PackedSingleLinkedList tmp_othrs(rhs);
+		this->swap(tmp_othrs);
+		return *this;
+	}
+
+	PackedSingleLinkedList& operator=(PackedSingleLinkedList&& rhs) noexcept {
+		if (this == &rhs) return *this;
+		Clear();
+		this->swap(rhs);
+		return *this;
+	}
+
+	void swap(PackedSingleLinkedList& other) noexcept {
+		std::swap(this->header_.head.next, other.header_.head.next);
+		std::swap(static_cast<SizePolicy&>(this->header_), static_cast<SizePolicy&>(other.header_));
+		std::swap(this->header_.Alloc(), other.header_.Alloc());
+	}
+
+	Iterator InsertAfter(ConstIterator pos, Type value) {
+		assert(pos.block_ != nullptr);
+
+		BlockBase* block = pos.block_;
+		size_t index = pos.index_ + 1;
+		if (block == &this->header_.head) {
+			block = this->header_.head.next;
+			index = 0;
+			if (block == nullptr || block->count == kCapacity) {
+				block = CreateBlock(this->header_.head.next);
+				this->header_.head.next = block;
+			}
+		}
+		else if (block->count == kCapacity) {
+			Block* fresh = CreateBlock(block->next);
+			block->next = fresh;
+			if (index == kCapacity) {
+				block = fresh;
+				index = 0;
+			}
+			else {
+				constexpr size_t kHalf = kCapacity / 2;
+				std::memcpy(fresh->words, static_cast<Block*>(block)->words + kWordsPerBlock / 2, sizeof(Word) * kWordsPerBlock / 2);
+				fresh->count = kHalf;
+				block->count = kHalf;
+				if (index > kHalf) {
+					block = fresh;
+					index -= kHalf;
+				}
+			}
+		}
+
+		Block* target = static_cast<Block*>(block);
+		ShiftUp(target->words, index, target->count);
+		Set(target->words, index, value);
+		++target->count;
+		this->header_.Add(1);
+		return Iterator(target, index);
+	}
+
+	void PopFront() noexcept {
+		assert(this->header_.head.next != nullptr);
+
+		if (this->header_.head.next == nullptr) return;
+		EraseAfter(this->cbefore_begin());
+	}
+
+	Iterator EraseAfter(ConstIterator pos) noexcept {
+		assert(pos.block_ != nullptr);
+
+		BlockBase* before = pos.block_;
+		BlockBase* block = before;
+		size_t index = pos.index_ + 1;
+		if (index == before->count) {
+			block = before->next;
+			index = 0;
+		}
+		assert(block != nullptr);
+
+		this->header_.Subtract(1);
+		if (block->count == 1) {
+			before->next = block->next;
+			DestroyBlock(block);
+			return Iterator(before->next, 0);
+		}
+
+		Block* target = static_cast<Block*>(block);
+		ShiftDown(target->words, index, target->count);
+		--target->count;
+		if (index == target->count) {
+			return Iterator(target->next, 0);
+		}
+		return Iterator(target, index);
+	}
+
+	// Counts matching elements a word (or, for bytes under SSE2, 16 bytes) at a
+	// time with popcount instead of visiting elements.
+	[[nodiscard]] size_t Count(Type value) const noexcept {
+		size_t result = 0;
+		for (const BlockBase* base = this->header_.head.next; base != nullptr; base = base->next) {
+			const Block& block = *static_cast<const Block*>(base);
+			if constexpr (kBits == 1) {
+				for (size_t word = 0; word * kPerWord < block.count; ++word) {
+					result += PopCount(MatchWord(block.words[word], value) & LowMask(block.count - word * kPerWord));
+				}
+			}
+			else {
+				result += PopCount(MatchBlock(block, value) & LowBits(block.count));
+			}
+		}
+		return result;
+	}
+
+	[[nodiscard]] Iterator Find(Type value) noexcept {
+		const ConstIterator found = std::as_const(*this).Find(value);
+		return Iterator(found.block_, found.index_);
+	}
+
+	[[nodiscard]] ConstIterator Find(Type value) const noexcept {
+		for (BlockBase* base = this->header_.head.next; base != nullptr; base = base->next) {
+			const Block& block = *static_cast<const Block*>(base);
+			if constexpr (kBits == 1) {
+				for (size_t word = 0; word * kPerWord < block.count; ++word) {
+					const Word matches = MatchWord(block.words[word], value) & LowMask(block.count - word * kPerWord);
+					if (matches != 0) {
+						return ConstIterator(base, word * kPerWord + CountTrailingZeros(matches));
+					}
+				}
+			}
+			else {
+				const uint64_t matches = MatchBlock(block, value) & LowBits(block.count);
+				if (matches != 0) {
+					return ConstIterator(base, CountTrailingZeros(matches));
+				}
+			}
+		}
+		return this->cend();
+	}
+
+	// Repacks the elements into full blocks.
+	void Compact() {
+		PackedSingleLinkedList tmp(this->get_allocator());
+		ConstIterator pos = tmp.cbefore_begin();
+		for (Type value : std::as_const(*this)) {
+			pos = tmp.InsertAfter(pos, value);
+		}
+		this->swap(tmp);
+	}
+
+	PackedSingleLinkedList SplitAfter(ConstIterator pos) {
+		assert(pos.block_ != nullptr);
+
+		PackedSingleLinkedList suffix(this->get_allocator());
+		BlockBase* block = pos.block_;
+		BlockBase* first = block->next;
+		const size_t tail = block == &this->header_.head ? 0 : block->count - (pos.index_ + 1);
+		if (tail != 0) {
+			Block* fresh = CreateBlock(block->next);
+			for (size_t i = 0; i < tail; ++i) {
+				Set(fresh->words, i, Get(static_cast<Block*>(block)->words, pos.index_ + 1 + i));
+			}
+			fresh->count = static_cast<uint32_t>(tail);
+			block->count = static_cast<uint32_t>(pos.index_ + 1);
+			first = fresh;
+		}
+		block->next = nullptr;
+
+		suffix.header_.head.next = first;
+		if constexpr (SizePolicy::kIsTracked) {
+			const size_t moved = CountFrom(first);
+			suffix.header_.Add(moved);
+			this->header_.Subtract(moved);
+		}
+		return suffix;
+	}
+
+	void Concat(PackedSingleLinkedList&& other) noexcept {
+		assert(this != &other);
+		assert(this->header_.Alloc() == other.header_.Alloc());
+
+		BlockBase* last = &this->header_.head;
+		while (last->next != nullptr) {
+			last = last->next;
+		}
+		last->next = other.header_.head.next;
+		if constexpr (SizePolicy::kIsTracked) {
+			this->header_.Add(other.header_.size);
+			other.header_.size = 0;
+		}
+		other.header_.head.next = nullptr;
+	}
+
+private:
+	struct Header : BlockAllocator, SizePolicy {
+		Header() = default;
+
+		explicit Header(const BlockAllocator& alloc)
+			: BlockAllocator(alloc) {}
+
+		[[nodiscard]] BlockAllocator& Alloc() noexcept {
+			return *this;
+		}
+
+		[[nodiscard]] const BlockAllocator& Alloc() const noexcept {
+			return *this;
+		}
+
+		// The head acts as a block holding one phantom element, so that
+		// before_begin() advances to the first real element like any other
+		// position.
+		BlockBase head{ nullptr, 1 };
+	};
+
+	Header header_;
+
+	[[nodiscard]] static Type Get(const Word* words, size_t index) noexcept {
+		return static_cast<Type>((words[index / kPerWord] >> (index % kPerWord * kBits)) & kElementMask);
+	}
+
+	static void Set(Word* words, size_t index, Type value) noexcept {
+		const size_t shift = index % kPerWord * kBits;
+		Word& word = words[index / kPerWord];
+		word = (word & ~(kElementMask << shift)) | (static_cast<Word>(value) << shift);
+	}
+
+	[[nodiscard]] static uint64_t LowBits(size_t bits) noexcept {
+		return bits >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << bits) - 1;
+	}
+
+	// Mask of the first `elements` slots of a word.
+	[[nodiscard]] static Word LowMask(size_t elements) noexcept {
+		return LowBits(elements * kBits);
+	}
+
+	// Moves elements [from, count) one slot up; the block must not be full.
+	static void ShiftUp(Word* words, size_t from, size_t count) noexcept {
+		const size_t first = from / kPerWord;
+		for (size_t word = count / kPerWord; word > first; --word) {
+			words[word] = (words[word] << kBits) | (words[word - 1] >> (kWordBits - kBits));
+		}
+		const Word low = LowMask(from % kPerWord);
+		words[first] = (words[first] & low) | ((words[first] << kBits) & ~low);
+	}
+
+	// Moves elements [from + 1, count) one slot down over the element at from.
+	static void ShiftDown(Word* words, size_t from, size_t count) noexcept {
+		const size_t first = from / kPerWord;
+		const size_t last = (count - 1) / kPerWord;
+		const Word low = LowMask(from % kPerWord);
+		for (size_t word = first; word <= last; ++word) {
+			const Word carry = word < last ? words[word + 1] << (kWordBits - kBits) : 0;
+			const Word keep = word == first ? low : 0;
+			words[word] = (words[word] & keep) | ((words[word] >> kBits) & ~keep) | carry;
+		}
+	}
+
+	// One set bit per matching bool.
+	[[nodiscard]] static Word MatchWord(Word word, Type value) noexcept {
+		return value ? word : ~word;
+	}
+
+	// One set bit per matching byte of the block, in element order.
+	[[nodiscard]] static uint64_t MatchBlock(const Block& block, Type value) noexcept {
+		uint64_t matches = 0;
+#if defined(__SSE2__)
+		const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+		for (size_t lane = 0; lane < kWordsPerBlock / 2; ++lane) {
+			const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.words + 2 * lane));
+			const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, needle)));
+			matches |= static_cast<uint64_t>(mask) << (16 * lane);
+		}
+#else
+		constexpr Word kLow7 = 0x7F7F7F7F7F7F7F7FULL;
+		constexpr Word kHigh = 0x8080808080808080ULL;
+		for (size_t word = 0; word < kWordsPerBlock; ++word) {
+			const Word diff = block.words[word] ^ (0x0101010101010101ULL * value);
+			const Word zero_bytes = ~(((diff & kLow7) + kLow7) | diff | kLow7) & kHigh;
+			matches |= ((zero_bytes * 0x02040810204081ULL) >> 56) << (8 * word);
+		}
+#endif
+		return matches;
+	}
+
+	[[nodiscard]] static size_t PopCount(uint64_t bits) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(__builtin_popcountll(bits));
+#else
+		size_t count = 0;
+		for (; bits != 0; bits &= bits - 1) {
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	[[nodiscard]] static size_t CountTrailingZeros(uint64_t bits) noexcept {
+		assert(bits != 0);
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+		size_t count = 0;
+		for (; (bits & 1) == 0; bits >>= 1) {
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	[[nodiscard]] static size_t CountFrom(const BlockBase* block) noexcept {
+		size_t count = 0;
+		for (; block != nullptr; block = block->next) {
+			count += block->count;
+		}
+		return count;
+	}
+
+	Block* CreateBlock(BlockBase* next) {
+		Block* block = BlockAllocatorTraits::allocate(this->header_.Alloc(), 1);
+		BlockAllocatorTraits::construct(this->header_.Alloc(), block);
+		block->next = next;
+		return block;
+	}
+
+	void DestroyBlock(BlockBase* base) noexcept {
+		Block* block = static_cast<Block*>(base);
+		BlockAllocatorTraits::destroy(this->header_.Alloc(), block);
+		BlockAllocatorTraits::deallocate(this->header_.Alloc(), block, 1);
+	}
+};
+
+template <typename Type, typename Allocator, typename SizePolicy>
+void swap(PackedSingleLinkedList<Type, Allocator, SizePolicy>& lhs, PackedSingleLinkedList<Type, Allocator, SizePolicy>& rhs) noexcept {
+	lhs.swap(rhs);
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+bool operator==(const PackedSingleLinkedList<Type, Allocator, SizePolicy>& lhs, const PackedSingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+bool operator!=(const PackedSingleLinkedList<Type, Allocator, SizePolicy>& lhs, const PackedSingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	return !(lhs == rhs);
+}
@@ -0,0 +1,1206 @@
+#pragma once
+
+#include "trivially_relocatable.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Under C++20 the list can be built and torn down during constant
+// evaluation: the sequential operations are constexpr and nodes come from
+// std::allocator, whose allocate/deallocate are constexpr there.
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+#define SLL_CONSTEXPR20 constexpr
+#else
+#define SLL_CONSTEXPR20
+#endif
+
+// Size policies for SingleLinkedList. TrackedSize keeps an element count so
+// GetSize() is O(1); every PushFront/InsertAfter/PopFront/EraseAfter pays one
+// extra read-modify-write for it, SplitAfter needs the suffix length and
+// SplitAfter(pos) walks the suffix to find it. UntrackedSize stores nothing,
+// like std::forward_list: an empty list is a single pointer, SplitAfter is
+// O(1) whatever the count, and GetSize() walks the list.
+struct TrackedSize {
+	static constexpr bool kIsTracked = true;
+
+	SLL_CONSTEXPR20 void Add(size_t count) noexcept {
+		this->size += count;
+	}
+
+	SLL_CONSTEXPR20 void Subtract(size_t count) noexcept {
+		assert(count <= this->size);
+		this->size -= count;
+	}
+
+	size_t size = 0;
+};
+
+struct UntrackedSize {
+	static constexpr bool kIsTracked = false;
+
+	SLL_CONSTEXPR20 void Add(size_t) noexcept {}
+	SLL_CONSTEXPR20 void Subtract(size_t) noexcept {}
+};
+
+enum class BatchOperationKind {
+	kInsert,
+	kErase,
+	kReplace,
+};
+
+// One entry of a SingleLinkedList::ApplyBatch batch. index names a position
+// in the list as it was before the batch; value is unused by kErase.
+template <typename Type>
+struct BatchOperation {
+	size_t index = 0;
+	BatchOperationKind kind = BatchOperationKind::kInsert;
+	std::optional<Type> value;
+};
+
+template <typename Type, typename Allocator = std::allocator<Type>, typename SizePolicy = TrackedSize>
+class SingleLinkedList {
+
+	struct Node;
+
+	struct NodeBase {
+		[[nodiscard]] SLL_CONSTEXPR20 Node* Next() const noexcept {
+			return static_cast<Node*>(this->next_node);
+		}
+
+		NodeBase* next_node = nullptr;
+	};
+
+	struct Node : NodeBase {
+		SLL_CONSTEXPR20 Node(const Type& val, NodeBase* next)
+			: NodeBase{ next }
+			, value(val) {}
+		SLL_CONSTEXPR20 Node(Type&& val, NodeBase* next)
+			: NodeBase{ next }
+			, value(std::move(val)) {}
+
+		Type value;
+	};
+
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+	using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+	template <typename ValueType>
+	class BasicIterator {
+		friend class SingleLinkedList;
+
+		SLL_CONSTEXPR20 explicit BasicIterator(NodeBase* node)
+			: node_(node) {}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = ValueType*;
+		using reference = ValueType&;
+
+		BasicIterator() = default;
+
+		SLL_CONSTEXPR20 BasicIterator(const BasicIterator<Type>& other) noexcept
+			: node_(other.node_) {}
+
+		BasicIterator& operator=(const BasicIterator& rhs) = default;
+
+		[[nodiscard]] SLL_CONSTEXPR20 bool operator==(const BasicIterator<const Type>& rhs) const noexcept {
+			return this->node_ == rhs.node_;
+		}
+
+		[[nodiscard]] SLL_CONSTEXPR20 bool operator!=(const BasicIterator<const Type>& rhs) const noexcept {
+			return this->node_ != rhs.node_;
+		}
+
+		[[nodiscard]] SLL_CONSTEXPR20 bool operator==(const BasicIterator<Type>& rhs) const noexcept {
+			return this->node_ == rhs.node_;
+		}
+
+		[[nodiscard]] SLL_CONSTEXPR20 bool operator!=(const BasicIterator<Type>& rhs) const noexcept {
+			return this->node_ != rhs.node_;
+		}
+
+		SLL_CONSTEXPR20 BasicIterator& operator++() noexcept {
+			this->node_ = this->node_->next_node;
+			return *this;
+		}
+
+		SLL_CONSTEXPR20 BasicIterator operator++(int) noexcept {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		[[nodiscard]] SLL_CONSTEXPR20 reference operator*() const noexcept {
+			return static_cast<Node*>(this->node_)->value;
+		}
+
+		[[nodiscard]] SLL_CONSTEXPR20 pointer operator->() const noexcept {
+			return &static_cast<Node*>(this->node_)->value;
+		}
+
+	private:
+		NodeBase* node_ = nullptr;
+	};
+
+public:
+	using value_type = Type;
+	using allocator_type = Allocator;
+	using size_policy = SizePolicy;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	using Iterator = BasicIterator<Type>;
+	using ConstIterator = BasicIterator<const Type>;
+
+	[[nodiscard]] SLL_CONSTEXPR20 Iterator begin() noexcept {
+		return Iterator(this->header_.head.next_node);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 Iterator end() noexcept {
+		return Iterator(nullptr);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 ConstIterator begin() const noexcept {
+		return ConstIterator(this->header_.head.next_node);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 ConstIterator end() const noexcept {
+		return ConstIterator(nullptr);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 ConstIterator cbegin() const noexcept {
+		return ConstIterator(this->header_.head.next_node);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 ConstIterator cend() const noexcept {
+		return ConstIterator(nullptr);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 Iterator before_begin() noexcept {
+		return Iterator(&this->header_.head);
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 ConstIterator cbefore_begin() const noexcept {
+		return ConstIterator(const_cast<NodeBase*>(&this->header_.head));
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 ConstIterator before_begin() const noexcept {
+		return ConstIterator(const_cast<NodeBase*>(&this->header_.head));
+	}
+
+	SingleLinkedList() = default;
+
+	SLL_CONSTEXPR20 explicit SingleLinkedList(const Allocator& alloc)
+		: header_(NodeAllocator(alloc)) {}
+
+	SLL_CONSTEXPR20 SingleLinkedList(std::initializer_list<Type> values, const Allocator& alloc = Allocator())
+		: header_(NodeAllocator(alloc)) {
+		InsertAfter(this->cbefore_begin(), values.begin(), values.end());
+	}
+
+	SLL_CONSTEXPR20 SingleLinkedList(const SingleLinkedList& other)
+		: header_(NodeAllocatorTraits::select_on_container_copy_construction(other.header_.Alloc())) {
+		InsertAfter(this->cbefore_begin(), other.begin(), other.end());
+	}
+
+	SLL_CONSTEXPR20 SingleLinkedList(SingleLinkedList&& other) noexcept
+		: header_(other.header_.Alloc()) {
+		this->swap(other);
+	}
+
+	SLL_CONSTEXPR20 ~SingleLinkedList() {
+		Clear();
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 allocator_type get_allocator() const noexcept {
+		return allocator_type(this->header_.Alloc());
+	}
+
+	// O(1) under TrackedSize, O(n) under UntrackedSize.
+	[[nodiscard]] SLL_CONSTEXPR20 size_t GetSize() const noexcept {
+		if constexpr (SizePolicy::kIsTracked) {
+			return this->header_.size;
+		}
+		else {
+			return CountFrom(this->header_.head.next_node);
+		}
+	}
+
+	[[nodiscard]] SLL_CONSTEXPR20 bool IsEmpty() const noexcept {
+		return this->header_.head.next_node == nullptr;
+	}
+
+	SLL_CONSTEXPR20 void PushFront(const Type& value) {
+		this->header_.head.next_node = CreateNode(this->header_.head.next_node, value);
+		this->header_.Add(1);
+	}
+
+	SLL_CONSTEXPR20 void PushFront(Type&& value) {
+		this->header_.head.next_node = CreateNode(this->header_.head.next_node, std::move(value));
+		this->header_.Add(1);
+	}
+
+	SLL_CONSTEXPR20 void Clear() noexcept {
+		while (this->header_.head.next_node != nullptr) {
+			PopFront();
+		}
+	}
+
+	SLL_CONSTEXPR20 SingleLinkedList& operator=(const SingleLinkedList& rhs) {
+		if (this == &rhs) return *this;
+		SingleLinkedList tmp_othrs(rhs);
+		this->swap(tmp_othrs);
+		return *this;
+	}
+
+	SLL_CONSTEXPR20 SingleLinkedList& operator=(SingleLinkedList&& rhs) noexcept {
+		if (this == &rhs) return *this;
+		Clear();
+		this->swap(rhs);
+		return *this;
+	}
+
+	SLL_CONSTEXPR20 void swap(SingleLinkedList& other) noexcept {
+		std::swap(this->header_.head.next_node, other.header_.head.next_node);
+		std::swap(static_cast<SizePolicy&>(this->header_), static_cast<SizePolicy&>(other.header_));
+		std::swap(this->header_.Alloc(), other.header_.Alloc());
+	}
+
+	SLL_CONSTEXPR20 Iterator InsertAfter(ConstIterator pos, const Type& value) {
+		assert(pos.node_ != nullptr);
+
+		NodeBase* before = pos.node_;
+		before->next_node = CreateNode(before->next_node, value);
+		this->header_.Add(1);
+		return Iterator(before->next_node);
+	}
+
+	SLL_CONSTEXPR20 Iterator InsertAfter(ConstIterator pos, Type&& value) {
+		assert(pos.node_ != nullptr);
+
+		NodeBase* before = pos.node_;
+		before->next_node = CreateNode(before->next_node, std::move(value));
+		this->header_.Add(1);
+		return Iterator(before->next_node);
+	}
+
+	// Inserts [first, last) after pos and returns the last inserted element,
+	// or pos for an empty range. The nodes are built into a detached chain
+	// that is linked in with one pointer write, so if an allocation or a copy
+	// throws, the list is left untouched. A forward range that moves its
+	// elements out without throwing gets every node allocated before the
+	// first element is moved, so a failed allocation leaves the range
+	// untouched too.
+	template <typename InputIterator>
+	SLL_CONSTEXPR20 Iterator InsertAfter(ConstIterator pos, InputIterator first, InputIterator last) {
+		assert(pos.node_ != nullptr);
+
+		using Traits = std::iterator_traits<InputIterator>;
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename Traits::iterator_category>
+			&& std::is_rvalue_reference_v<typename Traits::reference>
+			&& std::is_nothrow_constructible_v<Type, typename Traits::reference>) {
+			if (!IsConstantEvaluated()) {
+				return InsertReservedAfter(pos, first, last);
+			}
+		}
+
+		NodeBase chain;
+		NodeBase* tail = &chain;
+		size_t count = 0;
+		try {
+			for (; first != last; ++first, ++count) {
+				tail->next_node = CreateNode(nullptr, *first);
+				tail = tail->next_node;
+			}
+		}
+		catch (...) {
+			DestroyChain(chain.next_node);
+			throw;
+		}
+
+		if (count == 0) return Iterator(pos.node_);
+		tail->next_node = pos.node_->next_node;
+		pos.node_->next_node = chain.next_node;
+		this->header_.Add(count);
+		return Iterator(tail);
+	}
+
+	SLL_CONSTEXPR20 void PopFront() noexcept {
+		assert(this->header_.head.next_node != nullptr);
+
+		if (this->header_.head.next_node == nullptr) return;
+		auto next_item = this->header_.head.next_node->next_node;
+		DestroyNode(this->header_.head.Next());
+		this->header_.head.next_node = next_item;
+		this->header_.Subtract(1);
+	}
+
+	SLL_CONSTEXPR20 Iterator EraseAfter(ConstIterator pos) noexcept {
+		assert(pos.node_ != nullptr);
+
+		NodeBase* before = pos.node_;
+		auto after_item = before->next_node->next_node;
+		DestroyNode(before->Next());
+		before->next_node = after_item;
+		this->header_.Subtract(1);
+		return Iterator(before->next_node);
+	}
+
+	// Erases the elements strictly between first and last, as
+	// std::forward_list::erase_after does: one pointer write unlinks them,
+	// then their nodes are freed in a single sweep. Returns last.
+	SLL_CONSTEXPR20 Iterator EraseAfter(ConstIterator first, ConstIterator last) noexcept {
+		assert(first.node_ != nullptr);
+
+		NodeBase* erased = first.node_->next_node;
+		first.node_->next_node = last.node_;
+		this->header_.Subtract(DestroyChain(erased, last.node_));
+		return Iterator(last.node_);
+	}
+
+	void Compact() {
+		if (this->header_.head.next_node == nullptr) return;
+
+		const size_t count = GetSize();
+		std::vector<Node*> fresh;
+		fresh.reserve(count);
+		try {
+			for (size_t i = 0; i < count; ++i) {
+				fresh.push_back(NodeAllocatorTraits::allocate(this->header_.Alloc(), 1));
+			}
+		}
+		catch (...) {
+			for (Node* node : fresh) {
+				NodeAllocatorTraits::deallocate(this->header_.Alloc(), node, 1);
+			}
+			throw;
+		}
+
+		if constexpr (kIsTriviallyRelocatable<Type>) {
+			Node* old = this->header_.head.Next();
+			for (size_t i = 0; i < fresh.size(); ++i) {
+				Node* next = old->Next();
+				// The fresh storage holds no object yet: begin the link's
+				// lifetime before anything writes through it, then move the
+				// payload bytes in behind it.
+				::new (static_cast<void*>(fresh[i])) NodeBase{ i + 1 < fresh.size() ? fresh[i + 1] : nullptr };
+				RelocateAt(std::addressof(fresh[i]->value), std::addressof(old->value));
+				NodeAllocatorTraits::deallocate(this->header_.Alloc(), old, 1);
+				old = next;
+			}
+		}
+		else {
+			constexpr bool kMoveNoexcept = std::is_nothrow_move_constructible_v<Type>;
+			size_t constructed = 0;
+			try {
+				Node* old = this->header_.head.Next();
+				for (; constructed < fresh.size(); ++constructed, old = old->Next()) {
+					Node* next = constructed + 1 < fresh.size() ? fresh[constructed + 1] : nullptr;
+					if constexpr (kMoveNoexcept) {
+						NodeAllocatorTraits::construct(this->header_.Alloc(), fresh[constructed], std::move(old->value), next);
+					}
+					else {
+						NodeAllocatorTraits::construct(this->header_.Alloc(), fresh[constructed], std::as_const(old->value), next);
+					}
+				}
+			}
+			catch (...) {
+				for (size_t i = 0; i < fresh.size(); ++i) {
+					if (i < constructed) {
+						NodeAllocatorTraits::destroy(this->header_.Alloc(), fresh[i]);
+					}
+					NodeAllocatorTraits::deallocate(this->header_.Alloc(), fresh[i], 1);
+				}
+				throw;
+			}
+
+			for (Node* old = this->header_.head.Next(); old != nullptr;) {
+				Node* next = old->Next();
+				DestroyNode(old);
+				old = next;
+			}
+		}
+		this->header_.head.next_node = fresh.front();
+	}
+
+	// count must be the suffix length; UntrackedSize ignores it.
+	SLL_CONSTEXPR20 SingleLinkedList SplitAfter(ConstIterator pos, size_t count) {
+		assert(pos.node_ != nullptr);
+		if constexpr (SizePolicy::kIsTracked) {
+			assert(count <= this->header_.size);
+		}
+
+		SingleLinkedList suffix(this->get_allocator());
+		suffix.header_.head.next_node = pos.node_->next_node;
+		suffix.header_.Add(count);
+		pos.node_->next_node = nullptr;
+		this->header_.Subtract(count);
+		return suffix;
+	}
+
+	SLL_CONSTEXPR20 SingleLinkedList SplitAfter(ConstIterator pos) {
+		assert(pos.node_ != nullptr);
+
+		if constexpr (SizePolicy::kIsTracked) {
+			return SplitAfter(pos, CountFrom(pos.node_->next_node));
+		}
+		else {
+			return SplitAfter(pos, 0);
+		}
+	}
+
+	SLL_CONSTEXPR20 void Concat(ConstIterator last, SingleLinkedList&& other) noexcept {
+		assert(last.node_ != nullptr);
+		assert(last.node_->next_node == nullptr);
+		assert(this != &other);
+		assert(this->header_.Alloc() == other.header_.Alloc());
+
+		last.node_->next_node = other.header_.head.next_node;
+		if constexpr (SizePolicy::kIsTracked) {
+			this->header_.Add(other.header_.size);
+			other.header_.size = 0;
+		}
+		other.header_.head.next_node = nullptr;
+	}
+
+	// Walks to the tail of this list first, so it is O(size()): the list keeps
+	// no tail pointer. Callers that need O(1) pass the tail iterator instead.
+	SLL_CONSTEXPR20 void Concat(SingleLinkedList&& other) noexcept {
+		NodeBase* last = &this->header_.head;
+		while (last->next_node != nullptr) {
+			last = last->next_node;
+		}
+		Concat(ConstIterator(last), std::move(other));
+	}
+
+	// Sorted set operations with std::set_union/set_intersection/set_difference
+	// semantics (duplicates included), for lists sorted by cmp. Both chains are
+	// walked once; kept nodes are relinked in place, so no payload is copied
+	// or moved, and dropped nodes are freed together after the walk. If cmp
+	// throws, the list stays sorted and no element is lost or duplicated, but
+	// its contents are unspecified.
+
+	// Merges other's nodes into this list; an element of other equivalent to
+	// one already matched here is destroyed. other ends up empty.
+	template <typename Compare = std::less<>>
+	SLL_CONSTEXPR20 void UnionWith(SingleLinkedList&& other, Compare cmp = Compare()) {
+		assert(this != &other);
+		assert(this->header_.Alloc() == other.header_.Alloc());
+
+		NodeBase* tail = &this->header_.head;
+		NodeBase* dropped = nullptr;
+		try {
+			while (tail->next_node != nullptr && other.header_.head.next_node != nullptr) {
+				Node* mine = tail->Next();
+				Node* theirs = other.header_.head.Next();
+				if (cmp(theirs->value, mine->value)) {
+					other.header_.head.next_node = theirs->next_node;
+					other.header_.Subtract(1);
+					theirs->next_node = mine;
+					tail->next_node = theirs;
+					this->header_.Add(1);
+					tail = theirs;
+				}
+				else {
+					if (!cmp(mine->value, theirs->value)) {
+						other.header_.head.next_node = theirs->next_node;
+						other.header_.Subtract(1);
+						theirs->next_node = dropped;
+						dropped = theirs;
+					}
+					tail = mine;
+				}
+			}
+		}
+		catch (...) {
+			DestroyChain(dropped);
+			throw;
+		}
+
+		if (other.header_.head.next_node != nullptr) {
+			Concat(ConstIterator(tail), std::move(other));
+		}
+		DestroyChain(dropped);
+	}
+
+	// Keeps only the elements that have an equivalent in other.
+	template <typename Compare = std::less<>>
+	SLL_CONSTEXPR20 void IntersectWith(const SingleLinkedList& other, Compare cmp = Compare()) {
+		NodeBase* tail = &this->header_.head;
+		const Node* theirs = other.header_.head.Next();
+		NodeBase* dropped = nullptr;
+		try {
+			while (tail->next_node != nullptr && theirs != nullptr) {
+				Node* mine = tail->Next();
+				if (cmp(theirs->value, mine->value)) {
+					theirs = theirs->Next();
+				}
+				else if (cmp(mine->value, theirs->value)) {
+					tail->next_node = mine->next_node;
+					mine->next_node = dropped;
+					dropped = mine;
+				}
+				else {
+					tail = mine;
+					theirs = theirs->Next();
+				}
+			}
+		}
+		catch (...) {
+			this->header_.Subtract(DestroyChain(dropped));
+			throw;
+		}
+
+		NodeBase* rest = tail->next_node;
+		tail->next_node = nullptr;
+		this->header_.Subtract(DestroyChain(dropped) + DestroyChain(rest));
+	}
+
+	// Removes the elements that have an equivalent in other.
+	template <typename Compare = std::less<>>
+	SLL_CONSTEXPR20 void DifferenceWith(const SingleLinkedList& other, Compare cmp = Compare()) {
+		if (this == &other) {
+			Clear();
+			return;
+		}
+
+		NodeBase* tail = &this->header_.head;
+		const Node* theirs = other.header_.head.Next();
+		NodeBase* dropped = nullptr;
+		try {
+			while (tail->next_node != nullptr && theirs != nullptr) {
+				Node* mine = tail->Next();
+				if (cmp(theirs->value, mine->value)) {
+					theirs = theirs->Next();
+				}
+				else if (cmp(mine->value, theirs->value)) {
+					tail = mine;
+				}
+				else {
+					tail->next_node = mine->next_node;
+					mine->next_node = dropped;
+					dropped = mine;
+					theirs = theirs->Next();
+				}
+			}
+		}
+		catch (...) {
+			this->header_.Subtract(DestroyChain(dropped));
+			throw;
+		}
+
+		this->header_.Subtract(DestroyChain(dropped));
+	}
+
+	// Applies a batch of edits in one pass over the list, O(n + m) instead of
+	// a walk from begin() per edit. Indices refer to the list before the batch
+	// and must not decrease; kInsert puts its value before the element at
+	// index (at the end for index == GetSize()), kErase and kReplace act on
+	// that element, and edits sharing an index list their inserts first.
+	// Every new node is built before the list is touched and the erased ones
+	// are freed together afterwards, so the strong guarantee holds. Values
+	// are copied, or moved through a move iterator.
+	template <typename OperationIterator>
+	void ApplyBatch(OperationIterator first, OperationIterator last) {
+		NodeBase staged;
+		NodeBase* staged_tail = &staged;
+		try {
+			for (OperationIterator it = first; it != last; ++it) {
+				auto&& operation = *it;
+				if (operation.kind != BatchOperationKind::kErase) {
+					assert(operation.value.has_value());
+					staged_tail->next_node = CreateNode(nullptr, *std::forward<decltype(operation)>(operation).value);
+					staged_tail = staged_tail->next_node;
+				}
+			}
+		}
+		catch (...) {
+			DestroyChain(staged.next_node);
+			throw;
+		}
+
+		// before precedes the original element at index, inserted nodes included.
+		NodeBase* before = &this->header_.head;
+		size_t index = 0;
+		size_t inserted = 0;
+		NodeBase* dropped = nullptr;
+		for (OperationIterator it = first; it != last; ++it) {
+			const size_t target = (*it).index;
+			const BatchOperationKind kind = (*it).kind;
+			assert(target >= index);
+			for (; index < target; ++index) {
+				assert(before->next_node != nullptr);
+				before = before->next_node;
+			}
+
+			if (kind != BatchOperationKind::kInsert) {
+				assert(before->next_node != nullptr);
+				NodeBase* victim = before->next_node;
+				before->next_node = victim->next_node;
+				victim->next_node = dropped;
+				dropped = victim;
+				++index;
+			}
+			if (kind != BatchOperationKind::kErase) {
+				NodeBase* node = staged.next_node;
+				staged.next_node = node->next_node;
+				node->next_node = before->next_node;
+				before->next_node = node;
+				before = node;
+				++inserted;
+			}
+		}
+
+		this->header_.Add(inserted);
+		this->header_.Subtract(DestroyChain(dropped));
+	}
+
+	template <typename Operations>
+	void ApplyBatch(const Operations& operations) {
+		ApplyBatch(std::begin(operations), std::end(operations));
+	}
+
+	// Merges the sorted runs in [first, last) into one sorted list by relinking
+	// their nodes, leaving the runs empty. A loser tree over the run heads picks
+	// each next node with about log2(k) comparisons, O(n log k) in all, and is
+	// the only allocation. Equivalent elements keep run order. If cmp throws,
+	// every node is back in some run and every run is still sorted.
+	//
+	// With thread_count other than 1 (0 means one per hardware thread), the
+	// runs are sampled for splitter keys, cut into disjoint key ranges and the
+	// ranges merged on separate threads, so cmp must be safe to call
+	// concurrently. Inputs too small to split are merged sequentially. The
+	// result takes the first run's allocator, so with an allocator that is not
+	// default-constructible the range must not be empty.
+	template <typename RunIterator, typename Compare = std::less<>>
+	static SingleLinkedList MergeAll(RunIterator first, RunIterator last, Compare cmp = Compare(), size_t thread_count = 1) {
+		if constexpr (std::is_default_constructible_v<Allocator>) {
+			if (first == last) return SingleLinkedList();
+		}
+		assert(first != last);
+
+		SingleLinkedList merged(first->get_allocator());
+		std::vector<NodeBase*> heads;
+		size_t total = 0;
+		for (RunIterator run = first; run != last; ++run) {
+			assert(run->header_.Alloc() == merged.header_.Alloc());
+			heads.push_back(run->header_.head.next_node);
+			if constexpr (SizePolicy::kIsTracked) {
+				total += run->header_.size;
+			}
+		}
+
+		for (RunIterator run = first; run != last; ++run) {
+			run->header_.head.next_node = nullptr;
+			if constexpr (SizePolicy::kIsTracked) {
+				run->header_.size = 0;
+			}
+		}
+		try {
+			if (thread_count == 1) {
+				MergeChains(heads, &merged.header_.head, cmp);
+			}
+			else {
+				MergeChainsInParallel(heads, &merged.header_.head, cmp, thread_count);
+			}
+		}
+		catch (...) {
+			size_t index = 0;
+			for (RunIterator run = first; run != last; ++run, ++index) {
+				run->header_.head.next_node = heads[index];
+				if constexpr (SizePolicy::kIsTracked) {
+					run->header_.size = CountFrom(heads[index]);
+				}
+			}
+			throw;
+		}
+		merged.header_.Add(total);
+		return merged;
+	}
+
+	template <typename Func>
+	void ParallelForEach(Func fn, size_t thread_count = 0, bool prefetch = false) {
+		RunChunks(thread_count, [&](size_t, Node* first, Node* last) {
+			for (Node* node = first; node != last; node = node->Next()) {
+				if (prefetch) {
+					PrefetchNode(node->next_node);
+				}
+				fn(node->value);
+			}
+		});
+	}
+
+	template <typename Func>
+	void ParallelForEach(Func fn, size_t thread_count = 0, bool prefetch = false) const {
+		RunChunks(thread_count, [&](size_t, Node* first, Node* last) {
+			for (Node* node = first; node != last; node = node->Next()) {
+				if (prefetch) {
+					PrefetchNode(node->next_node);
+				}
+				fn(static_cast<const Type&>(node->value));
+			}
+		});
+	}
+
+	template <typename T, typename Reduce, typename Transform>
+	[[nodiscard]] T ParallelTransformReduce(T init, Reduce reduce, Transform transform,
+		size_t thread_count = 0, bool prefetch = false) const {
+		std::vector<std::optional<T>> partials(std::max<size_t>(ChunkCount(thread_count), 1));
+		RunChunks(thread_count, [&](size_t chunk, Node* first, Node* last) {
+			T acc = transform(static_cast<const Type&>(first->value));
+			for (Node* node = first->Next(); node != last; node = node->Next()) {
+				if (prefetch) {
+					PrefetchNode(node->next_node);
+				}
+				acc = reduce(std::move(acc), transform(static_cast<const Type&>(node->value)));
+			}
+			partials[chunk].emplace(std::move(acc));
+		});
+
+		for (auto& partial : partials) {
+			if (partial) {
+				init = reduce(std::move(init), std::move(*partial));
+			}
+		}
+		return init;
+	}
+
+private:
+	// Derives from the node allocator and the size policy so that empty ones
+	// take no space: with std::allocator and UntrackedSize the whole list is
+	// one pointer.
+	struct Header : NodeAllocator, SizePolicy {
+		Header() = default;
+
+		SLL_CONSTEXPR20 explicit Header(const NodeAllocator& alloc)
+			: NodeAllocator(alloc) {}
+
+		[[nodiscard]] SLL_CONSTEXPR20 NodeAllocator& Alloc() noexcept {
+			return *this;
+		}
+
+		[[nodiscard]] SLL_CONSTEXPR20 const NodeAllocator& Alloc() const noexcept {
+			return *this;
+		}
+
+		NodeBase head;
+	};
+
+	Header header_;
+
+	[[nodiscard]] SLL_CONSTEXPR20 static size_t CountFrom(const NodeBase* node) noexcept {
+		size_t count = 0;
+		for (; node != nullptr; node = node->next_node) {
+			++count;
+		}
+		return count;
+	}
+
+	// Reports constant evaluation, where node storage cannot be reused
+	// through placement new. Always false before C++20.
+	static constexpr bool IsConstantEvaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+		return std::is_constant_evaluated();
+#else
+		return false;
+#endif
+	}
+
+	// Range InsertAfter for elements that are moved out without throwing.
+	// Every node is allocated before the first element is moved; until then
+	// the raw nodes are chained through a NodeBase placed in their storage,
+	// so the reservation needs no side storage of its own.
+	template <typename ForwardIterator>
+	Iterator InsertReservedAfter(ConstIterator pos, ForwardIterator first, ForwardIterator last) {
+		NodeBase reserved;
+		NodeBase* reserved_tail = &reserved;
+		try {
+			for (ForwardIterator it = first; it != last; ++it) {
+				Node* node = NodeAllocatorTraits::allocate(this->header_.Alloc(), 1);
+				reserved_tail->next_node = ::new (static_cast<void*>(node)) NodeBase{ nullptr };
+				reserved_tail = reserved_tail->next_node;
+			}
+		}
+		catch (...) {
+			for (NodeBase* raw = reserved.next_node; raw != nullptr;) {
+				NodeBase* next = raw->next_node;
+				NodeAllocatorTraits::deallocate(this->header_.Alloc(), reinterpret_cast<Node*>(raw), 1);
+				raw = next;
+			}
+			throw;
+		}
+
+		if (reserved.next_node == nullptr) return Iterator(pos.node_);
+
+		NodeBase* tail = pos.node_;
+		NodeBase* const after = pos.node_->next_node;
+		size_t count = 0;
+		for (NodeBase* raw = reserved.next_node; raw != nullptr; ++first, ++count) {
+			NodeBase* next = raw->next_node;
+			Node* node = reinterpret_cast<Node*>(raw);
+			NodeAllocatorTraits::construct(this->header_.Alloc(), node, *first, after);
+			tail->next_node = node;
+			tail = node;
+			raw = next;
+		}
+		this->header_.Add(count);
+		return Iterator(tail);
+	}
+
+	template <typename... Args>
+	SLL_CONSTEXPR20 Node* CreateNode(NodeBase* next, Args&&... args) {
+		Node* node = NodeAllocatorTraits::allocate(this->header_.Alloc(), 1);
+		try {
+			NodeAllocatorTraits::construct(this->header_.Alloc(), node, std::forward<Args>(args)..., next);
+		}
+		catch (...) {
+			NodeAllocatorTraits::deallocate(this->header_.Alloc(), node, 1);
+			throw;
+		}
+		return node;
+	}
+
+	SLL_CONSTEXPR20 void DestroyNode(Node* node) noexcept {
+		NodeAllocatorTraits::destroy(this->header_.Alloc(), node);
+		NodeAllocatorTraits::deallocate(this->header_.Alloc(), node, 1);
+	}
+
+	// Destroys the chain of detached nodes from node up to stop; returns how
+	// many.
+	SLL_CONSTEXPR20 size_t DestroyChain(NodeBase* node, const NodeBase* stop = nullptr) noexcept {
+		size_t count = 0;
+		while (node != stop) {
+			NodeBase* next = node->next_node;
+			DestroyNode(static_cast<Node*>(node));
+			node = next;
+			++count;
+		}
+		return count;
+	}
+
+	static constexpr size_t kMergeSamplesPerRange = 16;
+	static constexpr size_t kMinParallelMergeRange = size_t{ 1 } << 14;
+
+	// Merges the sorted chains in heads onto out and returns the last merged
+	// node. Empty chains sort after everything and ties go to the lower index.
+	// If cmp throws, the merged prefix is pushed back onto heads[0]: it sorts
+	// before every node still in any chain.
+	template <typename Compare>
+	static NodeBase* MergeChains(std::vector<NodeBase*>& heads, NodeBase* out, Compare& cmp) {
+		constexpr size_t kNone = static_cast<size_t>(-1);
+		const size_t run_count = heads.size();
+		if (run_count == 0) {
+			out->next_node = nullptr;
+			return out;
+		}
+
+		auto beats = [&](size_t lhs, size_t rhs) {
+			if (heads[rhs] == nullptr) return true;
+			if (heads[lhs] == nullptr) return false;
+			const Type& lhs_value = static_cast<Node*>(heads[lhs])->value;
+			const Type& rhs_value = static_cast<Node*>(heads[rhs])->value;
+			return lhs < rhs ? !cmp(rhs_value, lhs_value) : static_cast<bool>(cmp(lhs_value, rhs_value));
+		};
+
+		// tree[0] holds the winner, tree[1..k) the loser of each match; leaf i
+		// sits at k + i in implicit heap order.
+		std::vector<size_t> tree(run_count, kNone);
+		NodeBase* tail = out;
+		try {
+			for (size_t run = 0; run < run_count; ++run) {
+				size_t winner = run;
+				for (size_t match = (run_count + run) / 2; match > 0; match /= 2) {
+					if (tree[match] == kNone) {
+						tree[match] = winner;
+						winner = kNone;
+						break;
+					}
+					if (beats(tree[match], winner)) {
+						std::swap(tree[match], winner);
+					}
+				}
+				if (winner != kNone) {
+					tree[0] = winner;
+				}
+			}
+
+			for (size_t winner = tree[0]; heads[winner] != nullptr; winner = tree[0]) {
+				tail->next_node = heads[winner];
+				tail = heads[winner];
+				heads[winner] = tail->next_node;
+				for (size_t match = (run_count + winner) / 2; match > 0; match /= 2) {
+					if (beats(tree[match], winner)) {
+						std::swap(tree[match], winner);
+					}
+				}
+				tree[0] = winner;
+			}
+		}
+		catch (...) {
+			if (tail != out) {
+				tail->next_node = heads[0];
+				heads[0] = out->next_node;
+			}
+			out->next_node = nullptr;
+			throw;
+		}
+		tail->next_node = nullptr;
+		return tail;
+	}
+
+	// Same contract as MergeChains, except that on failure the nodes of one
+	// key range may all have moved to heads[0]; every chain is still sorted.
+	template <typename Compare>
+	static void MergeChainsInParallel(std::vector<NodeBase*>& heads, NodeBase* out, Compare& cmp, size_t thread_count) {
+		if (thread_count == 0) {
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		const size_t run_count = heads.size();
+
+		std::vector<size_t> lengths(run_count);
+		std::vector<std::vector<const Type*>> samples(run_count);
+		RunTasks(run_count, thread_count, [&](size_t run) {
+			lengths[run] = CountFrom(heads[run]);
+			const size_t stride = std::max<size_t>(1, lengths[run] / (thread_count * kMergeSamplesPerRange));
+			size_t index = 0;
+			for (const NodeBase* node = heads[run]; node != nullptr; node = node->next_node, ++index) {
+				if (index % stride == stride / 2) {
+					samples[run].push_back(&static_cast<const Node*>(node)->value);
+				}
+			}
+		});
+
+		size_t total = 0;
+		std::vector<const Type*> pool;
+		for (size_t run = 0; run < run_count; ++run) {
+			total += lengths[run];
+			pool.insert(pool.end(), samples[run].begin(), samples[run].end());
+		}
+		const size_t range_target = std::min(thread_count, total / kMinParallelMergeRange);
+		if (range_target < 2) {
+			MergeChains(heads, out, cmp);
+			return;
+		}
+
+		std::sort(pool.begin(), pool.end(), [&](const Type* lhs, const Type* rhs) { return cmp(*lhs, *rhs); });
+		std::vector<const Type*> splitters;
+		for (size_t range = 1; range < range_target; ++range) {
+			const Type* splitter = pool[range * pool.size() / range_target];
+			if (splitters.empty() || cmp(*splitters.back(), *splitter)) {
+				splitters.push_back(splitter);
+			}
+		}
+
+		// ranges[r][run] is the part of run whose keys fall in range r; a node
+		// belongs to the first range whose upper splitter it sorts before.
+		const size_t range_count = splitters.size() + 1;
+		std::vector<std::vector<NodeBase*>> ranges(range_count, std::vector<NodeBase*>(run_count));
+		std::vector<std::vector<NodeBase*>> cuts(run_count);
+		std::vector<NodeBase> outputs(range_count);
+		std::vector<NodeBase*> tails(range_count);
+		std::vector<char> done(range_count, 0);
+		RunTasks(run_count, thread_count, [&](size_t run) {
+			size_t range = 0;
+			NodeBase* previous = nullptr;
+			for (NodeBase* node = heads[run]; node != nullptr; previous = node, node = node->next_node) {
+				const Type& value = static_cast<Node*>(node)->value;
+				if (previous != nullptr && (range == splitters.size() || cmp(value, *splitters[range]))) continue;
+
+				while (range < splitters.size() && !cmp(value, *splitters[range])) {
+					++range;
+				}
+				ranges[range][run] = node;
+				if (previous != nullptr) {
+					cuts[run].push_back(previous);
+				}
+			}
+		});
+		for (const auto& run_cuts : cuts) {
+			for (NodeBase* cut : run_cuts) {
+				cut->next_node = nullptr;
+			}
+		}
+
+		try {
+			RunTasks(range_count, thread_count, [&](size_t range) {
+				tails[range] = MergeChains(ranges[range], &outputs[range], cmp);
+				done[range] = 1;
+			});
+		}
+		catch (...) {
+			for (size_t range = 0; range < range_count; ++range) {
+				if (done[range]) {
+					ranges[range][0] = outputs[range].next_node;
+				}
+			}
+			for (size_t run = 0; run < run_count; ++run) {
+				NodeBase joined;
+				NodeBase* tail = &joined;
+				for (size_t range = 0; range < range_count; ++range) {
+					tail->next_node = ranges[range][run];
+					while (tail->next_node != nullptr) {
+						tail = tail->next_node;
+					}
+				}
+				heads[run] = joined.next_node;
+			}
+			throw;
+		}
+
+		NodeBase* tail = out;
+		for (size_t range = 0; range < range_count; ++range) {
+			if (outputs[range].next_node != nullptr) {
+				tail->next_node = outputs[range].next_node;
+				tail = tails[range];
+			}
+		}
+		tail->next_node = nullptr;
+	}
+
+	static void PrefetchNode([[maybe_unused]] const NodeBase* node) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(node);
+#endif
+	}
+
+	[[nodiscard]] size_t ChunkCount(size_t thread_count) const noexcept {
+		if (thread_count == 0) {
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		return std::min(thread_count, GetSize());
+	}
+
+	[[nodiscard]] std::vector<Node*> ChunkBoundaries(size_t chunk_count) const {
+		std::vector<Node*> bounds;
+		bounds.reserve(chunk_count + 1);
+		if (chunk_count == 0) {
+			return bounds;
+		}
+
+		const size_t chunk_size = (GetSize() + chunk_count - 1) / chunk_count;
+		size_t index = 0;
+		for (Node* node = this->header_.head.Next(); node != nullptr; node = node->Next(), ++index) {
+			if (index % chunk_size == 0) {
+				bounds.push_back(node);
+			}
+		}
+		bounds.push_back(nullptr);
+		return bounds;
+	}
+
+	template <typename ChunkFunc>
+	void RunChunks(size_t thread_count, ChunkFunc chunk_fn) const {
+		const std::vector<Node*> bounds = ChunkBoundaries(ChunkCount(thread_count));
+		if (bounds.size() < 2) {
+			return;
+		}
+
+		const size_t chunk_count = bounds.size() - 1;
+		RunTasks(chunk_count, chunk_count, [&](size_t chunk) {
+			chunk_fn(chunk, bounds[chunk], bounds[chunk + 1]);
+		});
+	}
+
+	// Runs task(0) .. task(task_count - 1) spread over up to thread_count
+	// threads, the calling one included, and rethrows the first failure.
+	template <typename TaskFunc>
+	static void RunTasks(size_t task_count, size_t thread_count, TaskFunc task) {
+		const size_t worker_count = std::min(thread_count, task_count);
+		if (worker_count == 0) {
+			return;
+		}
+
+		std::vector<std::exception_ptr> errors(worker_count);
+		auto run_worker = [&](size_t worker) {
+			try {
+				for (size_t index = worker; index < task_count; index += worker_count) {
+					task(index);
+				}
+			}
+			catch (...) {
+				errors[worker] = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(worker_count - 1);
+		for (size_t worker = 1; worker < worker_count; ++worker) {
+			threads.emplace_back(run_worker, worker);
+		}
+		run_worker(0);
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		for (const auto& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	}
+};
+
+// MergeAll over a contiguous range of lists, e.g. a std::vector or
+// std::array of sorted runs; see SingleLinkedList::MergeAll.
+template <typename Runs, typename Compare = std::less<>>
+auto MergeAll(Runs& runs, Compare cmp = Compare(), size_t thread_count = 1) {
+	using List = std::remove_reference_t<decltype(*std::begin(runs))>;
+	return List::MergeAll(std::begin(runs), std::end(runs), std::move(cmp), thread_count);
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 void swap(SingleLinkedList<Type, Allocator, SizePolicy>& lhs, SingleLinkedList<Type, Allocator, SizePolicy>& rhs) noexcept {
+	lhs.swap(rhs);
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 bool operator==(const SingleLinkedList<Type, Allocator, SizePolicy>& lhs, const SingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	if constexpr (SizePolicy::kIsTracked) {
+		if (lhs.GetSize() != rhs.GetSize()) return false;
+	}
+	return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 bool operator!=(const SingleLinkedList<Type, Allocator, SizePolicy>& lhs, const SingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	if (lhs == rhs) return false;
+	else return true;
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 bool operator<(const SingleLinkedList<Type, Allocator, SizePolicy>& lhs, const SingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 bool operator<=(const SingleLinkedList<Type, Allocator, SizePolicy>& lhs, const SingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	if (rhs < lhs) return false;
+	else return true;
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 bool operator>(const SingleLinkedList<Type, Allocator, SizePolicy>& lhs, const SingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	if (rhs < lhs) return true;
+	else return false;
+}
+
+template <typename Type, typename Allocator, typename SizePolicy>
+SLL_CONSTEXPR20 bool operator>=(const SingleLinkedList<Type, Allocator, SizePolicy>& lhs, const SingleLinkedList<Type, Allocator, SizePolicy>& rhs) {
+	if (rhs > lhs) return false;
+	else return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "single_linked_list.hpp"
+
+#include <array>
+#include <cstddef>
+
+// Read-only sequence baked into static storage: a list built during constant
+// evaluation, flattened into an array so it is initialized with the program
+// image and startup does no work for it.
+template <typename Type, size_t N>
+class StaticList {
+public:
+	using value_type = Type;
+	using ConstIterator = const Type*;
+
+	constexpr explicit StaticList(const std::array<Type, N>& values)
+		: values_(values) {}
+
+	[[nodiscard]] constexpr ConstIterator begin() const noexcept {
+		return this->values_.data();
+	}
+
+	[[nodiscard]] constexpr ConstIterator end() const noexcept {
+		return this->values_.data() + N;
+	}
+
+	[[nodiscard]] constexpr ConstIterator cbegin() const noexcept {
+		return begin();
+	}
+
+	[[nodiscard]] constexpr ConstIterator cend() const noexcept {
+		return end();
+	}
+
+	[[nodiscard]] constexpr size_t GetSize() const noexcept {
+		return N;
+	}
+
+	[[nodiscard]] constexpr bool IsEmpty() const noexcept {
+		return N == 0;
+	}
+
+	[[nodiscard]] constexpr const Type& operator[](size_t index) const noexcept {
+		return this->values_[index];
+	}
+
+private:
+	std::array<Type, N> values_;
+};
+
+template <typename Type, size_t N>
+constexpr bool operator==(const StaticList<Type, N>& lhs, const StaticList<Type, N>& rhs) {
+	for (size_t i = 0; i < N; ++i) {
+		if (!(lhs[i] == rhs[i])) return false;
+	}
+	return true;
+}
+
+template <typename Type, size_t N>
+constexpr bool operator!=(const StaticList<Type, N>& lhs, const StaticList<Type, N>& rhs) {
+	return !(lhs == rhs);
+}
+
+#if defined(__cpp_consteval) && defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+
+// Runs a captureless builder that returns a SingleLinkedList and copies the
+// result, in order, into a StaticList. Nodes allocated during constant
+// evaluation must be freed before it ends, so the list itself cannot be kept;
+// its values can. Type must be default-constructible and a literal type.
+//
+//     constexpr auto kTable = MaterializeList([] {
+//         SingleLinkedList<int> list;
+//         list.PushFront(2);
+//         list.PushFront(1);
+//         return list;
+//     });
+template <typename Builder>
+consteval auto MaterializeList(Builder) {
+	using List = decltype(Builder{}());
+	using Type = typename List::value_type;
+	constexpr size_t kSize = Builder{}().GetSize();
+
+	const List list = Builder{}();
+	std::array<Type, kSize> values{};
+	size_t index = 0;
+	for (const Type& value : list) {
+		values[index++] = value;
+	}
+	return StaticList<Type, kSize>(values);
+}
+
+#endif
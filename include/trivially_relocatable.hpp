@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename Type>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Type> {};
+
+template <typename Type>
+struct IsTriviallyRelocatable<std::unique_ptr<Type>> : std::true_type {};
+
+template <typename Type>
+struct IsTriviallyRelocatable<std::shared_ptr<Type>> : std::true_type {};
+
+// std::vector is three pointers in the release configurations of the major
+// standard libraries. Checked-iterator modes (_GLIBCXX_DEBUG, libc++ debug
+// mode, MSVC _ITERATOR_DEBUG_LEVEL > 0) keep bookkeeping that points back at
+// the container, so it is only opted in where that is known to be absent.
+#if (defined(__GLIBCXX__) && !defined(_GLIBCXX_DEBUG)) \
+	|| (defined(_LIBCPP_VERSION) && !defined(_LIBCPP_ENABLE_DEBUG_MODE) && !(defined(_LIBCPP_DEBUG) && _LIBCPP_DEBUG >= 1)) \
+	|| (defined(_MSVC_STL_VERSION) && defined(_ITERATOR_DEBUG_LEVEL) && _ITERATOR_DEBUG_LEVEL == 0)
+#define SLL_VECTOR_IS_TRIVIALLY_RELOCATABLE 1
+#endif
+
+#if defined(SLL_VECTOR_IS_TRIVIALLY_RELOCATABLE)
+template <typename Type>
+struct IsTriviallyRelocatable<std::vector<Type>> : std::true_type {};
+#endif
+
+template <typename First, typename Second>
+struct IsTriviallyRelocatable<std::pair<First, Second>>
+	: std::bool_constant<IsTriviallyRelocatable<First>::value && IsTriviallyRelocatable<Second>::value> {};
+
+#if defined(_LIBCPP_VERSION)
+template <>
+struct IsTriviallyRelocatable<std::string> : std::true_type {};
+#endif
+
+template <typename Type>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<Type>::value;
+
+template <typename Type>
+inline constexpr bool kIsNothrowRelocatable = kIsTriviallyRelocatable<Type> || std::is_nothrow_move_constructible_v<Type>;
+
+template <typename Type>
+void RelocateAt(Type* destination, Type* source) noexcept(kIsNothrowRelocatable<Type>) {
+	if constexpr (kIsTriviallyRelocatable<Type>) {
+		std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), sizeof(Type));
+	}
+	else {
+		::new (static_cast<void*>(destination)) Type(std::move(*source));
+		source->~Type();
+	}
+}
+
+template <typename Type>
+void RelocateRange(Type* destination, Type* source, size_t count) noexcept(kIsNothrowRelocatable<Type>) {
+	if constexpr (kIsTriviallyRelocatable<Type>) {
+		if (count != 0) {
+			std::memmove(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(Type));
+		}
+	}
+	else {
+		for (size_t i = 0; i < count; ++i) {
+			RelocateAt(destination + i, source + i);
+		}
+	}
+}
@@ -0,0 +1,62 @@
+// Replacement global allocation functions for the test binary. They live in
+// their own translation unit so the compiler cannot pair an inlined
+// operator new with the free() in operator delete.
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Allocations the current thread may still make before operator new throws
+// std::bad_alloc; negative means unlimited. Lets tests inject allocation
+// failure into containers that allocate through std::allocator.
+thread_local long g_allocation_budget = -1;
+
+static void* AllocateWithinBudget(std::size_t bytes) noexcept {
+	if (g_allocation_budget == 0) return nullptr;
+	if (g_allocation_budget > 0) {
+		--g_allocation_budget;
+	}
+	return std::malloc(bytes == 0 ? 1 : bytes);
+}
+
+void* operator new(std::size_t bytes) {
+	if (void* block = AllocateWithinBudget(bytes)) return block;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes) {
+	if (void* block = AllocateWithinBudget(bytes)) return block;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {
+	return AllocateWithinBudget(bytes);
+}
+
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept {
+	return AllocateWithinBudget(bytes);
+}
+
+void operator delete(void* block) noexcept {
+	std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+	std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+	std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+	std::free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+	std::free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+	std::free(block);
+}
@@ -0,0 +1,2037 @@
+#include "adaptive_list.hpp"
+#include "concurrent_lists.hpp"
+#include "frozen_list.hpp"
+#include "inline_string_list.hpp"
+#include "latency_histogram.hpp"
+#include "list_trace.hpp"
+#include "node_allocators.hpp"
+#include "packed_single_linked_list.hpp"
+#include "single_linked_list.hpp"
+#include "static_list.hpp"
+#include "trivially_relocatable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Allocations the current thread may still make before operator new throws
+// std::bad_alloc; negative means unlimited. Defined with the replacement
+// allocation functions in allocation_budget.cpp.
+extern thread_local long g_allocation_budget;
+
+void Test4() {
+	struct DeletionSpy {
+		~DeletionSpy() {
+			if (deletion_counter_ptr) {
+				++(*deletion_counter_ptr);
+			}
+		}
+		int* deletion_counter_ptr = nullptr;
+	};
+
+	{
+		SingleLinkedList<int> numbers{ 3, 14, 15, 92, 6 };
+		numbers.PopFront();
+		assert((numbers == SingleLinkedList<int>{14, 15, 92, 6}));
+
+		SingleLinkedList<DeletionSpy> list;
+		list.PushFront(DeletionSpy{});
+		int deletion_counter = 0;
+		list.begin()->deletion_counter_ptr = &deletion_counter;
+		assert(deletion_counter == 0);
+		list.PopFront();
+		assert(deletion_counter == 1);
+	}
+
+	{
+		SingleLinkedList<int> empty_list;
+		const auto& const_empty_list = empty_list;
+		assert(empty_list.before_begin() == empty_list.cbefore_begin());
+		assert(++empty_list.before_begin() == empty_list.begin());
+		assert(++empty_list.cbefore_begin() == const_empty_list.begin());
+
+		SingleLinkedList<int> numbers{ 1, 2, 3, 4 };
+		const auto& const_numbers = numbers;
+		assert(numbers.before_begin() == numbers.cbefore_begin());
+		assert(++numbers.before_begin() == numbers.begin());
+		assert(++numbers.cbefore_begin() == const_numbers.begin());
+	}
+
+	{
+		{
+			SingleLinkedList<int> lst;
+			const auto inserted_item_pos = lst.InsertAfter(lst.before_begin(), 123);
+			assert((lst == SingleLinkedList<int>{123}));
+			assert(inserted_item_pos == lst.begin());
+			assert(*inserted_item_pos == 123);
+		}
+
+		{
+			SingleLinkedList<int> lst{ 1, 2, 3 };
+			auto inserted_item_pos = lst.InsertAfter(lst.before_begin(), 123);
+
+			assert(inserted_item_pos == lst.begin());
+			assert(inserted_item_pos != lst.end());
+			assert(*inserted_item_pos == 123);
+			assert((lst == SingleLinkedList<int>{123, 1, 2, 3}));
+
+			inserted_item_pos = lst.InsertAfter(lst.begin(), 555);
+			assert(++SingleLinkedList<int>::Iterator(lst.begin()) == inserted_item_pos);
+			assert(*inserted_item_pos == 555);
+			assert((lst == SingleLinkedList<int>{123, 555, 1, 2, 3}));
+		};
+	}
+
+	struct ThrowOnCopy {
+		ThrowOnCopy() = default;
+		explicit ThrowOnCopy(int& copy_counter) noexcept
+			: countdown_ptr(&copy_counter) {}
+
+		ThrowOnCopy(const ThrowOnCopy& other)
+			: countdown_ptr(other.countdown_ptr) 
+		{
+			if (countdown_ptr) {
+				if (*countdown_ptr == 0) {
+					throw std::bad_alloc();
+				}
+				else {
+					--(*countdown_ptr);
+				}
+			}
+		}
+
+		ThrowOnCopy& operator=(const ThrowOnCopy& rhs) = delete;
+		int* countdown_ptr = nullptr;
+	};
+
+	{
+		bool exception_was_thrown = false;
+		for (int max_copy_counter = 10; max_copy_counter >= 0; --max_copy_counter) {
+			SingleLinkedList<ThrowOnCopy> list{ ThrowOnCopy{}, ThrowOnCopy{}, ThrowOnCopy{} };
+			try {
+				int copy_counter = max_copy_counter;
+				list.InsertAfter(list.cbegin(), ThrowOnCopy(copy_counter));
+				assert(list.GetSize() == 4u);
+			}
+			catch (const std::bad_alloc&) {
+				exception_was_thrown = true;
+				assert(list.GetSize() == 3u);
+				break;
+			}
+		}
+		assert(exception_was_thrown);
+	}
+
+	{
+		{
+			SingleLinkedList<int> lst{ 1, 2, 3, 4 };
+			const auto& const_lst = lst;
+			const auto item_after_erased = lst.EraseAfter(const_lst.cbefore_begin());
+			assert((lst == SingleLinkedList<int>{2, 3, 4}));
+			assert(item_after_erased == lst.begin());
+		}
+		{
+			SingleLinkedList<int> lst{ 1, 2, 3, 4 };
+			const auto item_after_erased = lst.EraseAfter(lst.cbegin());
+			assert((lst == SingleLinkedList<int>{1, 3, 4}));
+			assert(item_after_erased == (++lst.begin()));
+		}
+		{
+			SingleLinkedList<int> lst{ 1, 2, 3, 4 };
+			const auto item_after_erased = lst.EraseAfter(++(++lst.cbegin()));
+			assert((lst == SingleLinkedList<int>{1, 2, 3}));
+			assert(item_after_erased == lst.end());
+		}
+		{
+			SingleLinkedList<DeletionSpy> list{ DeletionSpy{}, DeletionSpy{}, DeletionSpy{} };
+			auto after_begin = ++list.begin();
+			int deletion_counter = 0;
+			after_begin->deletion_counter_ptr = &deletion_counter;
+			assert(deletion_counter == 0u);
+			list.EraseAfter(list.cbegin());
+			assert(deletion_counter == 1u);
+		}
+	}
+}
+
+void Test5() {
+	{
+		SingleLinkedList<int> numbers{ 1, 2, 3, 4, 5 };
+		auto suffix = numbers.SplitAfter(++numbers.cbegin(), 3);
+		assert((numbers == SingleLinkedList<int>{1, 2}));
+		assert((suffix == SingleLinkedList<int>{3, 4, 5}));
+		assert(numbers.GetSize() == 2u && suffix.GetSize() == 3u);
+
+		auto all = numbers.SplitAfter(numbers.cbefore_begin(), 2);
+		assert(numbers.IsEmpty() && numbers.begin() == numbers.end());
+		assert((all == SingleLinkedList<int>{1, 2}));
+
+		SingleLinkedList<int> moved(std::move(suffix));
+		assert(suffix.IsEmpty());
+		assert((moved == SingleLinkedList<int>{3, 4, 5}));
+		moved = std::move(all);
+		assert((moved == SingleLinkedList<int>{1, 2}));
+	}
+
+	{
+		std::atomic<int> leaves{ 0 };
+		std::function<void(WorkStealingScheduler&, int)> spawn = [&](WorkStealingScheduler& scheduler, int depth) {
+			if (depth == 0) {
+				++leaves;
+				return;
+			}
+			scheduler.Submit([&, depth] { spawn(scheduler, depth - 1); });
+			scheduler.Submit([&, depth] { spawn(scheduler, depth - 1); });
+		};
+
+		WorkStealingScheduler scheduler(4);
+		scheduler.Submit([&] { spawn(scheduler, 10); });
+		scheduler.Wait();
+		assert(leaves == 1024);
+
+		scheduler.Submit([&] { spawn(scheduler, 3); });
+		scheduler.Wait();
+		assert(leaves == 1032);
+
+		// One task queues far more than a steal walks; thieves still drain it.
+		scheduler.Submit([&] {
+			for (int i = 0; i < 5000; ++i) {
+				scheduler.Submit([&] { ++leaves; });
+			}
+		});
+		scheduler.Wait();
+		assert(leaves == 6032);
+
+		scheduler.Submit([] { throw std::runtime_error("task"); });
+		scheduler.Submit([&] { spawn(scheduler, 2); });
+		try {
+			scheduler.Wait();
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert(leaves == 6036);
+		scheduler.Submit([&] { ++leaves; });
+		scheduler.Wait();
+		assert(leaves == 6037);
+	}
+}
+
+void Test6() {
+	{
+		SingleLinkedList<int> empty_list;
+		empty_list.ParallelForEach([](int&) { assert(false); });
+		assert(empty_list.ParallelTransformReduce(7, std::plus<>{}, [](int x) { return x; }) == 7);
+	}
+
+	{
+		SingleLinkedList<int> numbers;
+		for (int i = 1000; i > 0; --i) {
+			numbers.PushFront(i);
+		}
+
+		for (size_t threads : { 1u, 3u, 4u, 7u, 2000u }) {
+			auto copy = numbers;
+			copy.ParallelForEach([](int& x) { x *= 2; }, threads, true);
+			assert(copy.ParallelTransformReduce(size_t{ 0 }, std::plus<>{},
+				[](int x) { return static_cast<size_t>(x); }, threads) == 1000u * 1001u);
+
+			std::string digits = copy.ParallelTransformReduce(std::string{}, std::plus<>{},
+				[](int x) { return std::to_string(x % 10); }, threads);
+			assert(digits.size() == 1000u && digits.substr(0, 5) == "24680");
+		}
+	}
+
+	{
+		SingleLinkedList<int> numbers{ 1, 2, 3, 4 };
+		bool exception_was_thrown = false;
+		try {
+			numbers.ParallelForEach([](int& x) {
+				if (x == 3) throw std::runtime_error("3");
+			}, 4);
+		}
+		catch (const std::runtime_error&) {
+			exception_was_thrown = true;
+		}
+		assert(exception_was_thrown);
+	}
+}
+
+void Test7() {
+	{
+		SingleLinkedList<int> numbers{ 1, 2, 3, 4, 5 };
+		auto suffix = numbers.SplitAfter(++numbers.cbegin());
+		assert((numbers == SingleLinkedList<int>{1, 2}));
+		assert((suffix == SingleLinkedList<int>{3, 4, 5}));
+		assert(suffix.GetSize() == 3u);
+
+		auto empty_suffix = suffix.SplitAfter(++(++suffix.cbegin()));
+		assert(empty_suffix.IsEmpty());
+		assert(suffix.GetSize() == 3u);
+
+		numbers.Concat(std::move(suffix));
+		assert(suffix.IsEmpty() && suffix.begin() == suffix.end());
+		assert((numbers == SingleLinkedList<int>{1, 2, 3, 4, 5}));
+		assert(numbers.GetSize() == 5u);
+
+		numbers.Concat(std::move(empty_suffix));
+		assert(numbers.GetSize() == 5u);
+	}
+
+	{
+		SingleLinkedList<int> lhs;
+		SingleLinkedList<int> rhs{ 1, 2 };
+		lhs.Concat(lhs.cbefore_begin(), std::move(rhs));
+		assert((lhs == SingleLinkedList<int>{1, 2}));
+
+		SingleLinkedList<int> tail{ 3 };
+		lhs.Concat(++lhs.cbegin(), std::move(tail));
+		assert((lhs == SingleLinkedList<int>{1, 2, 3}));
+		assert(lhs.GetSize() == 3u);
+	}
+}
+
+void Test8() {
+	{
+		ShardedBag<int> bag(4);
+		assert(!bag.TryPop());
+		assert(bag.Collect().IsEmpty());
+
+		bag.Push(1);
+		bag.Push(2);
+		assert(bag.TryPop() == 2);
+		assert((bag.Collect() == SingleLinkedList<int>{1}));
+		assert(bag.Collect().IsEmpty());
+	}
+
+	{
+		constexpr int kThreads = 8;
+		constexpr int kPerThread = 1000;
+		ShardedBag<int> bag(3);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < kThreads; ++t) {
+			threads.emplace_back([&bag, t] {
+				for (int i = 0; i < kPerThread; ++i) {
+					bag.Push(t * kPerThread + i);
+				}
+				for (int i = 0; i < kPerThread / 4; ++i) {
+					assert(bag.TryPop());
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		SingleLinkedList<int> items = bag.Collect();
+		assert(items.GetSize() == kThreads * kPerThread * 3u / 4u);
+		size_t counted = 0;
+		for (int value : items) {
+			assert(value >= 0 && value < kThreads * kPerThread);
+			++counted;
+		}
+		assert(counted == items.GetSize());
+	}
+}
+
+void Test9() {
+	{
+		RcuList<int> list;
+		assert(list.Read().IsEmpty());
+
+		list.PushFront(3);
+		list.PushFront(1);
+		list.Insert(1, 2);
+		list.Insert(3, 4);
+		{
+			auto snapshot = list.Read();
+			assert(snapshot.GetSize() == 4u);
+			assert((std::vector<int>(snapshot.begin(), snapshot.end()) == std::vector<int>{1, 2, 3, 4}));
+
+			list.Replace(0, 10);
+			list.Erase(2);
+			assert((std::vector<int>(snapshot.begin(), snapshot.end()) == std::vector<int>{1, 2, 3, 4}));
+			assert(list.GetRetiredCount() > 0u);
+		}
+		list.Reclaim();
+		assert(list.GetRetiredCount() == 0u);
+
+		auto current = list.Read();
+		assert((std::vector<int>(current.begin(), current.end()) == std::vector<int>{10, 2, 4}));
+	}
+
+	{
+		RcuList<int> list;
+		list.Assign(SingleLinkedList<int>{ 5, 6, 7 });
+		auto snapshot = list.Read();
+		assert((std::vector<int>(snapshot.begin(), snapshot.end()) == std::vector<int>{5, 6, 7}));
+	}
+
+	{
+		RcuList<int> list(4);
+		list.Assign(SingleLinkedList<int>{ 0, 0, 0, 0 });
+		std::atomic<bool> done{ false };
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 6; ++t) {
+			readers.emplace_back([&] {
+				while (!done.load()) {
+					auto snapshot = list.Read();
+					int first = *snapshot.begin();
+					size_t size = 0;
+					for (int value : snapshot) {
+						assert(value == first);
+						++size;
+					}
+					assert(size == snapshot.GetSize());
+				}
+			});
+		}
+		for (int version = 1; version <= 200; ++version) {
+			list.Assign(SingleLinkedList<int>{ version, version, version, version });
+		}
+		done = true;
+		for (auto& reader : readers) {
+			reader.join();
+		}
+	}
+
+	{
+		// More readers hold snapshots at once than the list has slots.
+		RcuList<int> list(1);
+		list.Assign(SingleLinkedList<int>{ 1, 2, 3 });
+		constexpr int kReaders = 6;
+		for (int wave = 0; wave < 2; ++wave) {
+			std::atomic<int> holding{ 0 };
+			std::atomic<bool> published{ false };
+			std::vector<std::thread> readers;
+			for (int t = 0; t < kReaders; ++t) {
+				readers.emplace_back([&] {
+					auto snapshot = list.Read();
+					const std::vector<int> seen(snapshot.begin(), snapshot.end());
+					{
+						auto nested = list.Read();
+						assert(nested.GetSize() >= 1u);
+					}
+					++holding;
+					while (!published.load()) {
+						std::this_thread::yield();
+					}
+					assert((std::vector<int>(snapshot.begin(), snapshot.end()) == seen));
+				});
+			}
+			while (holding.load() < kReaders) {
+				std::this_thread::yield();
+			}
+			for (int version = 0; version < 50; ++version) {
+				list.Assign(SingleLinkedList<int>{ version, wave });
+			}
+			assert(list.GetRetiredCount() > 0u);
+			published = true;
+			for (auto& reader : readers) {
+				reader.join();
+			}
+			list.Reclaim();
+			assert(list.GetRetiredCount() == 0u);
+		}
+	}
+}
+
+void Test10() {
+	using CachedList = SingleLinkedList<int, NodeCacheAllocator<int>>;
+
+	{
+		CachedList numbers{ 1, 2, 3 };
+		numbers.InsertAfter(numbers.cbegin(), 5);
+		numbers.EraseAfter(numbers.cbefore_begin());
+		assert((numbers == CachedList{5, 2, 3}));
+
+		CachedList copy = numbers;
+		copy.PopFront();
+		assert((copy == CachedList{2, 3}));
+		assert((numbers == CachedList{5, 2, 3}));
+
+		for (int i = 0; i < 10000; ++i) {
+			copy.PushFront(i);
+		}
+		copy.Clear();
+		for (int i = 0; i < 10000; ++i) {
+			copy.PushFront(i);
+		}
+		assert(copy.GetSize() == 10000u);
+	}
+
+	{
+		SingleLinkedList<std::string, NodeCacheAllocator<std::string>> words{ "a", "b" };
+		words.PushFront(std::string(100, 'x'));
+		assert(words.GetSize() == 3u && words.begin()->size() == 100u);
+	}
+
+	{
+		std::vector<CachedList> lists(4);
+		for (int i = 0; i < 1000; ++i) {
+			for (auto& list : lists) {
+				list.PushFront(i);
+			}
+		}
+
+		std::vector<std::thread> threads;
+		for (auto& list : lists) {
+			threads.emplace_back([&list] {
+				CachedList local = std::move(list);
+				for (int i = 0; i < 1000; ++i) {
+					local.PushFront(i);
+				}
+				assert(local.GetSize() == 2000u);
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	{
+		// Constructed before the thread's cache, so destroyed after it.
+		std::thread([] {
+			thread_local CachedList late_list;
+			for (int i = 0; i < 1000; ++i) {
+				late_list.PushFront(i);
+			}
+		}).join();
+
+		// Freed at program exit, after main's cache and possibly the depot.
+		static CachedList static_list;
+		for (int i = 0; i < 1000; ++i) {
+			static_list.PushFront(i);
+		}
+	}
+}
+
+void Test11() {
+	for (HugePages huge_pages : { HugePages::kNone, HugePages::kTransparent, HugePages::kExplicit }) {
+		NodeArena arena(huge_pages, 1);
+		assert(arena.GetReservedBytes() == 0u);
+
+		{
+			NodeArena fresh(huge_pages, 1);
+			void* first_block = fresh.Allocate(sizeof(int), alignof(int));
+			assert(reinterpret_cast<uintptr_t>(first_block) % NodeArena::kHugePageSize == 0);
+			fresh.Deallocate(first_block, sizeof(int));
+		}
+
+		using ArenaList = SingleLinkedList<int, ArenaAllocator<int>>;
+		ArenaList numbers(ArenaAllocator<int>{ arena });
+		for (int i = 0; i < 200000; ++i) {
+			numbers.PushFront(i);
+		}
+		assert(arena.GetReservedBytes() >= 2 * NodeArena::kHugePageSize);
+		if (huge_pages == HugePages::kNone) {
+			assert(arena.GetHugePages() == HugePages::kNone);
+		}
+
+		const size_t reserved = arena.GetReservedBytes();
+		numbers.Clear();
+		for (int i = 0; i < 200000; ++i) {
+			numbers.PushFront(i);
+		}
+		assert(arena.GetReservedBytes() == reserved);
+
+		ArenaList copy = numbers;
+		assert(copy == numbers);
+		assert(&copy.get_allocator().GetArena() == &arena);
+		auto suffix = copy.SplitAfter(copy.cbegin());
+		assert(suffix.get_allocator() == copy.get_allocator());
+		assert(suffix.GetSize() == 199999u);
+	}
+}
+
+void Test12() {
+	AllocationStats stats;
+	using CountedList = SingleLinkedList<int, CountingAllocator<int>>;
+	const CountingAllocator<int> alloc(stats);
+
+	auto measure = [&stats](auto&& operation) {
+		const AllocationStats before = stats;
+		operation();
+		return stats - before;
+	};
+
+	{
+		AllocationStats delta = measure([&] { CountedList empty_list(alloc); });
+		assert(delta.allocations == 0u && delta.deallocations == 0u);
+
+		CountedList numbers(alloc);
+		delta = measure([&] { numbers.PushFront(1); });
+		assert(delta.allocations == 1u && delta.deallocations == 0u);
+		assert(delta.bytes_allocated >= sizeof(int) + sizeof(void*));
+
+		delta = measure([&] { numbers.InsertAfter(numbers.cbegin(), 2); });
+		assert(delta.allocations == 1u && delta.deallocations == 0u);
+
+		delta = measure([&] { numbers.EraseAfter(numbers.cbegin()); });
+		assert(delta.allocations == 0u && delta.deallocations == 1u);
+
+		delta = measure([&] { numbers.PopFront(); });
+		assert(delta.allocations == 0u && delta.deallocations == 1u);
+		assert(stats.bytes_allocated == stats.bytes_deallocated);
+	}
+
+	{
+		constexpr size_t kSize = 100;
+		CountedList numbers(alloc);
+		for (size_t i = 0; i < kSize; ++i) {
+			numbers.PushFront(static_cast<int>(i));
+		}
+
+		AllocationStats delta = measure([&] {
+			CountedList moved(std::move(numbers));
+			numbers = std::move(moved);
+		});
+		assert(delta.allocations == 0u && delta.deallocations == 0u);
+
+		delta = measure([&] {
+			CountedList other(alloc);
+			numbers.swap(other);
+			swap(numbers, other);
+		});
+		assert(delta.allocations == 0u && delta.deallocations == 0u);
+
+		delta = measure([&] {
+			auto suffix = numbers.SplitAfter(numbers.cbegin());
+			auto rest = suffix.SplitAfter(suffix.cbegin(), kSize - 2);
+			numbers.Concat(std::move(suffix));
+			numbers.Concat(std::move(rest));
+		});
+		assert(delta.allocations == 0u && delta.deallocations == 0u);
+		assert(numbers.GetSize() == kSize);
+
+		delta = measure([&] {
+			numbers.ParallelForEach([](int& x) { ++x; }, 4);
+			(void)numbers.ParallelTransformReduce(0, std::plus<>{}, [](int x) { return x; }, 4);
+		});
+		assert(delta.allocations == 0u && delta.deallocations == 0u);
+
+		delta = measure([&] { CountedList copy(numbers); });
+		assert(delta.allocations == kSize && delta.deallocations == kSize);
+
+		const std::vector<int> extra(kSize, 7);
+		delta = measure([&] { numbers.InsertAfter(numbers.cbegin(), extra.begin(), extra.end()); });
+		assert(delta.allocations == kSize && delta.deallocations == 0u);
+
+		delta = measure([&] { numbers.EraseAfter(numbers.cbegin(), std::next(numbers.cbegin(), kSize + 1)); });
+		assert(delta.allocations == 0u && delta.deallocations == kSize);
+		assert(numbers.GetSize() == kSize);
+
+		delta = measure([&] { numbers.Clear(); });
+		assert(delta.allocations == 0u && delta.deallocations == kSize);
+	}
+
+	{
+		AllocationStats delta = measure([&] { CountedList numbers({ 1, 2, 3 }, alloc); });
+		assert(delta.allocations == 3u && delta.deallocations == 3u);
+	}
+
+	assert(stats.allocations == stats.deallocations);
+	assert(stats.bytes_allocated == stats.bytes_deallocated);
+}
+
+void Test13() {
+	LatencyHistogram histogram;
+	assert(histogram.Percentile(50) == 0u);
+
+	for (uint64_t value = 1; value <= 1000; ++value) {
+		histogram.Record(value);
+	}
+	histogram.Record(1'000'000);
+	assert(histogram.GetTotal() == 1001u);
+	assert(histogram.GetMax() == 1'000'000u);
+
+	const uint64_t median = histogram.Percentile(50);
+	assert(median >= 500u && median <= 505u);
+	const uint64_t p99 = histogram.Percentile(99);
+	assert(p99 >= 990u && p99 <= 1000u);
+	assert(histogram.Percentile(100) == 1'000'000u);
+
+	for (uint64_t value : { uint64_t{ 0 }, uint64_t{ 127 }, uint64_t{ 128 }, uint64_t{ 12345 }, std::numeric_limits<uint64_t>::max() }) {
+		LatencyHistogram single;
+		single.Record(value);
+		const uint64_t reported = single.Percentile(50);
+		assert(reported == value || (reported < value && value - reported <= value / 64));
+	}
+}
+
+void Test14() {
+	std::stringstream buffer;
+	TraceWriter writer(buffer);
+	TracingList<int> list(writer);
+
+	list.PushFront(0);
+	list.PushFront(1);
+	auto pos = list.InsertAfter(++list.begin(), 2);
+	assert(list.IndexOf(pos) == 3u && *pos == 2);
+	for (int i = 0; i < 300; ++i) {
+		pos = list.InsertAfter(pos, 3 + i);
+	}
+	list.EraseAfter(list.begin());
+	list.PopFront();
+	int sum = 0;
+	list.ForEach([&sum](int value) { sum += value; });
+	assert(sum == 2 + 300 * 3 + 299 * 300 / 2);
+
+	TraceReader reader(buffer);
+	const std::vector<TraceRecord> trace = reader.ReadAll();
+	assert(trace.size() == 306u);
+	assert((trace[0] == TraceRecord{ TraceOperation::kPushFront }));
+	assert((trace[2] == TraceRecord{ TraceOperation::kInsertAfter, 2 }));
+	assert((trace[302] == TraceRecord{ TraceOperation::kInsertAfter, 302 }));
+	assert((trace[303] == TraceRecord{ TraceOperation::kEraseAfter, 1 }));
+	assert((trace[304] == TraceRecord{ TraceOperation::kPopFront }));
+	assert((trace[305] == TraceRecord{ TraceOperation::kIterate }));
+
+	{
+		// Positions held across other mutations must record their current index.
+		std::stringstream stale_buffer;
+		TraceWriter stale_writer(stale_buffer);
+		TracingList<int> stale_list(stale_writer);
+		stale_list.PushFront(1);
+		const auto one = stale_list.begin();
+		stale_list.PushFront(0);
+		stale_list.InsertAfter(one, 2);
+		const auto zero = stale_list.begin();
+		stale_list.PushFront(-1);
+		stale_list.InsertAfter(zero, 5);
+		stale_list.EraseAfter(zero);
+		assert(stale_list.IndexOf(one) == 3u);
+		assert((stale_list.GetList() == SingleLinkedList<int>{ -1, 0, 1, 2 }));
+
+		TraceReader stale_reader(stale_buffer);
+		const std::vector<int> values{ 1, 0, 2, -1, 5 };
+		size_t next_value = 0;
+		SingleLinkedList<int> replayed;
+		for (const TraceRecord& record : stale_reader.ReadAll()) {
+			const auto before = std::next(replayed.cbefore_begin(), static_cast<std::ptrdiff_t>(record.position));
+			switch (record.operation) {
+			case TraceOperation::kPushFront:
+				replayed.PushFront(values[next_value++]);
+				break;
+			case TraceOperation::kInsertAfter:
+				replayed.InsertAfter(before, values[next_value++]);
+				break;
+			case TraceOperation::kEraseAfter:
+				replayed.EraseAfter(before);
+				break;
+			default:
+				assert(false);
+			}
+		}
+		assert(replayed == stale_list.GetList());
+	}
+
+	std::stringstream garbage("not a trace");
+	bool exception_was_thrown = false;
+	try {
+		TraceReader bad_reader(garbage);
+	}
+	catch (const std::runtime_error&) {
+		exception_was_thrown = true;
+	}
+	assert(exception_was_thrown);
+}
+
+struct ThrowOnCopyForCompact {
+	ThrowOnCopyForCompact() = default;
+	ThrowOnCopyForCompact(const ThrowOnCopyForCompact& other)
+		: countdown_ptr(other.countdown_ptr) {
+		if (countdown_ptr) {
+			if (*countdown_ptr == 0) {
+				throw std::bad_alloc();
+			}
+			--(*countdown_ptr);
+		}
+	}
+	int* countdown_ptr = nullptr;
+};
+
+void Test15() {
+	struct SelfReferencing {
+		SelfReferencing()
+			: self(this) {}
+		SelfReferencing(const SelfReferencing&)
+			: self(this) {}
+		SelfReferencing* self;
+	};
+
+	static_assert(kIsTriviallyRelocatable<int>);
+	static_assert(kIsTriviallyRelocatable<std::pair<int, double>>);
+	static_assert(kIsTriviallyRelocatable<std::unique_ptr<int>>);
+#if defined(SLL_VECTOR_IS_TRIVIALLY_RELOCATABLE)
+	static_assert(kIsTriviallyRelocatable<std::vector<std::string>>);
+#else
+	static_assert(!kIsTriviallyRelocatable<std::vector<std::string>>);
+#endif
+	static_assert(!kIsTriviallyRelocatable<SelfReferencing>);
+
+	{
+		alignas(std::unique_ptr<int>) unsigned char storage[3 * sizeof(std::unique_ptr<int>)];
+		std::unique_ptr<int> source[3] = { std::make_unique<int>(1), std::make_unique<int>(2), std::make_unique<int>(3) };
+		auto* destination = reinterpret_cast<std::unique_ptr<int>*>(storage);
+		RelocateRange(destination, source, 3);
+		assert(*destination[0] == 1 && *destination[2] == 3);
+		for (auto& relocated : source) {
+			new (&relocated) std::unique_ptr<int>();
+		}
+		std::destroy_n(destination, 3);
+	}
+
+	{
+		SingleLinkedList<SelfReferencing> list;
+		list.PushFront(SelfReferencing{});
+		list.PushFront(SelfReferencing{});
+		list.Compact();
+		for (const SelfReferencing& item : list) {
+			assert(item.self == &item);
+		}
+	}
+
+	{
+		AllocationStats stats;
+		SingleLinkedList<std::unique_ptr<int>, CountingAllocator<std::unique_ptr<int>>> list(CountingAllocator<std::unique_ptr<int>>{ stats });
+		for (int i = 0; i < 100; ++i) {
+			list.PushFront(std::make_unique<int>(i));
+		}
+		const AllocationStats before = stats;
+		list.Compact();
+		const AllocationStats delta = stats - before;
+		assert(delta.allocations == 100u && delta.deallocations == 100u);
+		assert(list.GetSize() == 100u);
+		int expected = 99;
+		for (const auto& item : list) {
+			assert(*item == expected--);
+		}
+	}
+
+	{
+		SingleLinkedList<std::string> words{ "alpha", std::string(100, 'b'), "gamma" };
+		const SingleLinkedList<std::string> copy = words;
+		words.Compact();
+		assert(words == copy);
+
+		SingleLinkedList<int> empty_list;
+		empty_list.Compact();
+		assert(empty_list.IsEmpty());
+	}
+
+	{
+		int copy_counter = 10;
+		SingleLinkedList<ThrowOnCopyForCompact> list;
+		for (int i = 0; i < 5; ++i) {
+			list.PushFront(ThrowOnCopyForCompact{});
+		}
+		for (auto& item : list) {
+			item.countdown_ptr = &copy_counter;
+		}
+		copy_counter = 2;
+		bool exception_was_thrown = false;
+		try {
+			list.Compact();
+		}
+		catch (const std::bad_alloc&) {
+			exception_was_thrown = true;
+		}
+		assert(exception_was_thrown);
+		assert(list.GetSize() == 5u);
+	}
+}
+
+void Test16() {
+	using UntrackedList = SingleLinkedList<int, std::allocator<int>, UntrackedSize>;
+	static_assert(sizeof(UntrackedList) == sizeof(void*));
+	static_assert(sizeof(SingleLinkedList<int>) == 2 * sizeof(void*));
+
+	{
+		UntrackedList numbers;
+		assert(numbers.IsEmpty() && numbers.GetSize() == 0u);
+		for (int i = 5; i > 0; --i) {
+			numbers.PushFront(i);
+		}
+		numbers.InsertAfter(numbers.cbegin(), 10);
+		assert(numbers.GetSize() == 6u);
+		assert((numbers == UntrackedList{ 1, 10, 2, 3, 4, 5 }));
+
+		numbers.EraseAfter(numbers.cbegin());
+		numbers.PopFront();
+		assert((numbers == UntrackedList{ 2, 3, 4, 5 }));
+
+		auto suffix = numbers.SplitAfter(numbers.cbegin());
+		assert((numbers == UntrackedList{ 2 }));
+		assert((suffix == UntrackedList{ 3, 4, 5 }));
+		auto tail = suffix.SplitAfter(suffix.cbegin(), 0);
+		assert(suffix.GetSize() == 1u && tail.GetSize() == 2u);
+
+		numbers.Concat(numbers.cbegin(), std::move(suffix));
+		numbers.Concat(std::move(tail));
+		assert(suffix.IsEmpty() && tail.IsEmpty());
+		assert((numbers == UntrackedList{ 2, 3, 4, 5 }));
+
+		UntrackedList copy = numbers;
+		copy.Compact();
+		assert(copy == numbers);
+		const int sum = copy.ParallelTransformReduce(0, std::plus<>(), [](int value) { return value; }, 3);
+		assert(sum == 14);
+
+		UntrackedList other;
+		swap(other, copy);
+		assert(copy.IsEmpty() && other.GetSize() == 4u);
+		other.Clear();
+		assert(other.IsEmpty());
+	}
+
+	{
+		// A shorter list must not compare equal to a longer one sharing its prefix.
+		const SingleLinkedList<int> short_tracked{ 1 };
+		const SingleLinkedList<int> long_tracked{ 1, 2, 3 };
+		assert(short_tracked != long_tracked && long_tracked != short_tracked);
+		assert(!(SingleLinkedList<int>{} == short_tracked) && !(short_tracked == SingleLinkedList<int>{}));
+
+		const UntrackedList short_untracked{ 1 };
+		const UntrackedList long_untracked{ 1, 2, 3 };
+		assert(short_untracked != long_untracked && long_untracked != short_untracked);
+		assert(!(UntrackedList{} == short_untracked) && !(short_untracked == UntrackedList{}));
+	}
+
+	{
+		AllocationStats stats;
+		using CountedUntracked = SingleLinkedList<int, CountingAllocator<int>, UntrackedSize>;
+		{
+			CountedUntracked list(CountingAllocator<int>{ stats });
+			for (int i = 0; i < 10; ++i) {
+				list.PushFront(i);
+			}
+			CountedUntracked moved = std::move(list);
+			assert(list.IsEmpty() && moved.GetSize() == 10u);
+		}
+		assert(stats.allocations == 10u && stats.deallocations == 10u);
+	}
+}
+
+template <typename Type, typename SizePolicy>
+void CheckPackedAgainstVector(unsigned seed) {
+	using PackedList = PackedSingleLinkedList<Type, std::allocator<Type>, SizePolicy>;
+	PackedList list;
+	std::vector<Type> expected;
+	unsigned state = seed;
+	auto next_random = [&state] {
+		state = state * 1103515245u + 12345u;
+		return state >> 8;
+	};
+
+	for (int step = 0; step < 20000; ++step) {
+		const unsigned roll = next_random() % 10;
+		const auto value = static_cast<Type>(next_random() % 256);
+		if (roll < 3 || expected.empty()) {
+			list.PushFront(value);
+			expected.insert(expected.begin(), value);
+		}
+		else if (roll < 7) {
+			const size_t index = next_random() % (expected.size() + 1);
+			auto pos = list.cbefore_begin();
+			for (size_t i = 0; i < index; ++i) {
+				++pos;
+			}
+			auto inserted = list.InsertAfter(pos, value);
+			assert(*inserted == value);
+			expected.insert(expected.begin() + index, value);
+		}
+		else if (roll < 9) {
+			const size_t index = next_random() % expected.size();
+			auto pos = list.cbefore_begin();
+			for (size_t i = 0; i < index; ++i) {
+				++pos;
+			}
+			auto after = list.EraseAfter(pos);
+			expected.erase(expected.begin() + index);
+			assert(index == expected.size() ? after == list.end() : *after == expected[index]);
+		}
+		else {
+			list.PopFront();
+			expected.erase(expected.begin());
+		}
+	}
+
+	assert(list.GetSize() == expected.size());
+	assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+	for (Type value : { Type(0), Type(1), static_cast<Type>(200) }) {
+		assert(list.Count(value) == static_cast<size_t>(std::count(expected.begin(), expected.end(), value)));
+		const auto found = list.Find(value);
+		const auto expected_found = std::find(expected.begin(), expected.end(), value);
+		if (expected_found == expected.end()) {
+			assert(found == list.end());
+		}
+		else {
+			assert(static_cast<size_t>(std::distance(list.begin(), found)) == static_cast<size_t>(expected_found - expected.begin()));
+		}
+	}
+
+	list.Compact();
+	assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+}
+
+// bool and uint8_t get the full SingleLinkedList; the bit-packed list is the
+// separate PackedSingleLinkedList. Explicit instantiation compiles every
+// non-template member, CheckFullListApi the member templates and the
+// containers built on SingleLinkedList.
+template class SingleLinkedList<bool>;
+template class SingleLinkedList<uint8_t>;
+
+template <typename Type>
+void CheckFullListApi() {
+	const Type values[] = { Type(0), Type(1), Type(1) };
+	SingleLinkedList<Type> list;
+	auto last = list.InsertAfter(list.cbefore_begin(), std::begin(values), std::end(values));
+	for (Type& value : list) {
+		Type& reference = value;
+		(void)reference;
+	}
+	list.EraseAfter(list.cbegin(), last);
+	assert(list.GetSize() == 2u);
+	list.Concat(list.cbegin(), list.SplitAfter(list.cbegin(), 1));
+	list.UnionWith(SingleLinkedList<Type>{ Type(1) });
+	list.IntersectWith(SingleLinkedList<Type>{ Type(0), Type(1), Type(1) });
+	list.DifferenceWith(SingleLinkedList<Type>{ Type(0) });
+	assert((list == SingleLinkedList<Type>{ Type(1) }));
+	list.ApplyBatch(std::vector<BatchOperation<Type>>{ { 0, BatchOperationKind::kInsert, Type(0) } });
+	list.ParallelForEach([](Type&) {});
+	assert(list.ParallelTransformReduce(size_t{ 0 }, std::plus<>(), [](const Type& value) { return static_cast<size_t>(value); }) == 1u);
+	std::vector<SingleLinkedList<Type>> runs(2, list);
+	assert(MergeAll(runs).GetSize() == 4u);
+
+	// AdaptiveList keeps its array form in a std::vector, which has no bool&.
+	if constexpr (!std::is_same_v<Type, bool>) {
+		AdaptiveList<Type> adaptive;
+		adaptive.PushFront(Type(1));
+		for (ListRepresentation target : { ListRepresentation::kUnrolled, ListRepresentation::kArray, ListRepresentation::kNodeList }) {
+			adaptive.MigrateTo(target);
+			assert(adaptive.At(0) == Type(1));
+		}
+	}
+	ShardedBag<Type> bag(2);
+	bag.Push(Type(1));
+	assert(bag.Collect().GetSize() == 1u);
+}
+
+void Test17() {
+	CheckPackedAgainstVector<bool, TrackedSize>(1);
+	CheckPackedAgainstVector<bool, UntrackedSize>(2);
+	CheckPackedAgainstVector<uint8_t, TrackedSize>(3);
+	CheckPackedAgainstVector<uint8_t, UntrackedSize>(4);
+
+	{
+		PackedSingleLinkedList<bool> flags{ true, false, false, true };
+		auto it = flags.begin();
+		*it = false;
+		(*++it).Flip();
+		*++it = *flags.begin();
+		assert((flags == PackedSingleLinkedList<bool>{ false, true, false, true }));
+		assert(flags.Count(true) == 2u && flags.Count(false) == 2u);
+
+		const PackedSingleLinkedList<bool> copy = flags;
+		assert(copy == flags);
+
+		auto suffix = flags.SplitAfter(flags.cbegin());
+		assert((flags == PackedSingleLinkedList<bool>{ false }));
+		assert((suffix == PackedSingleLinkedList<bool>{ true, false, true }));
+		assert(flags.GetSize() == 1u && suffix.GetSize() == 3u);
+		flags.Concat(std::move(suffix));
+		assert(flags == copy && suffix.IsEmpty());
+
+		PackedSingleLinkedList<bool> empty;
+		assert(empty.Find(true) == empty.end() && empty.Count(false) == 0u);
+	}
+
+	{
+		constexpr size_t kElements = 100000;
+		AllocationStats stats;
+		{
+			PackedSingleLinkedList<bool, CountingAllocator<bool>> flags(CountingAllocator<bool>{ stats });
+			auto pos = flags.cbefore_begin();
+			for (size_t i = 0; i < kElements; ++i) {
+				pos = flags.InsertAfter(pos, i % 3 == 0);
+			}
+			assert(flags.Count(true) == (kElements + 2) / 3);
+			assert(stats.bytes_allocated * 90 <= kElements * 2 * sizeof(void*));
+		}
+		assert(stats.allocations == stats.deallocations);
+
+		const AllocationStats before = stats;
+		{
+			PackedSingleLinkedList<uint8_t, CountingAllocator<uint8_t>> bytes(CountingAllocator<uint8_t>{ stats });
+			for (size_t i = 0; i < kElements; ++i) {
+				bytes.PushFront(static_cast<uint8_t>(i));
+			}
+			assert(bytes.Count(7) == kElements / 256 + (kElements % 256 > 7));
+		}
+		const AllocationStats delta = stats - before;
+		assert(delta.bytes_allocated * 10 <= kElements * 2 * sizeof(void*));
+	}
+
+	CheckFullListApi<bool>();
+	CheckFullListApi<uint8_t>();
+}
+
+void Test18() {
+	{
+		InlineStringList<> words{ "alpha", "", "gamma" };
+		assert(words.GetSize() == 3u);
+		const std::vector<std::string_view> expected{ "alpha", "", "gamma" };
+		assert(std::equal(words.begin(), words.end(), expected.begin(), expected.end()));
+
+		const std::string_view front = words.EmplaceFront("zero");
+		assert(front == "zero" && *words.begin() == "zero");
+
+		auto pos = words.InsertAfter(words.cbegin(), "one");
+		words.EraseAfter(pos);
+		words.PopFront();
+		assert((words == InlineStringList<>{ "one", "", "gamma" }));
+
+		const std::string long_string(10000, 'x');
+		words.InsertAfter(words.cbegin(), long_string);
+		assert(*++words.cbegin() == long_string);
+
+		InlineStringList<> copy = words;
+		assert(copy == words);
+		InlineStringList<> moved = std::move(copy);
+		assert(copy.IsEmpty() && moved == words);
+
+		moved.Clear();
+		assert(moved.IsEmpty() && moved.GetArenaBytes() == 0u);
+		moved.EmplaceFront("again");
+		assert(*moved.begin() == "again");
+	}
+
+	{
+		constexpr size_t kTokens = 10000;
+		AllocationStats stats;
+		{
+			InlineStringList<CountingAllocator<char>> tokens(CountingAllocator<char>{ stats });
+			auto pos = tokens.cbefore_begin();
+			for (size_t i = 0; i < kTokens; ++i) {
+				pos = tokens.InsertAfter(pos, "token" + std::to_string(i));
+			}
+			assert(tokens.GetSize() == kTokens);
+			assert(stats.allocations < 16u);
+
+			size_t index = 0;
+			for (std::string_view token : tokens) {
+				assert(token == "token" + std::to_string(index++));
+			}
+
+			const AllocationStats before = stats;
+			tokens.Clear();
+			const AllocationStats delta = stats - before;
+			assert(delta.allocations == 0u && delta.deallocations == before.allocations);
+		}
+		assert(stats.allocations == stats.deallocations);
+	}
+}
+
+template <typename Type>
+void CheckCompressedRoundTrip(const std::vector<Type>& values) {
+	SingleLinkedList<Type> list;
+	auto pos = list.cbefore_begin();
+	for (Type value : values) {
+		pos = list.InsertAfter(pos, value);
+	}
+
+	const auto compressed = FreezeCompressed(list);
+	assert(compressed.GetSize() == values.size());
+	assert(std::equal(compressed.begin(), compressed.end(), values.begin(), values.end()));
+
+	std::vector<Type> decoded(values.size());
+	compressed.DecodeTo(decoded.data());
+	assert(decoded == values);
+
+	size_t index = 0;
+	compressed.ForEach([&](Type value) {
+		assert(value == values[index++]);
+	});
+	assert(index == values.size());
+	assert(compressed.Thaw() == list);
+}
+
+void Test19() {
+	{
+		SingleLinkedList<std::string> words{ "alpha", "beta", std::string(100, 'c') };
+		const SingleLinkedList<std::string> original = words;
+
+		const FrozenList<std::string> copied = Freeze(words);
+		assert(words == original);
+		assert(copied.GetSize() == 3u && *copied.begin() == "alpha");
+		assert(std::equal(copied.begin(), copied.end(), original.begin(), original.end()));
+		assert(copied.end() - copied.begin() == 3);
+
+		FrozenList<std::string> frozen = Freeze(std::move(words));
+		assert(words.IsEmpty());
+		assert(std::equal(frozen.begin(), frozen.end(), original.begin(), original.end()));
+
+		assert(copied.Thaw() == original);
+		SingleLinkedList<std::string> thawed = std::move(frozen).Thaw();
+		assert(thawed == original && frozen.IsEmpty());
+
+		auto untracked = copied.Thaw<UntrackedSize>();
+		assert(untracked.GetSize() == 3u);
+
+		const FrozenList<int> empty = Freeze(SingleLinkedList<int>{});
+		assert(empty.IsEmpty() && empty.begin() == empty.end());
+	}
+
+	{
+		// A thaw that runs out of memory leaves the frozen values in place.
+		// The strings are too long for the small-string buffer, so their
+		// moves actually steal the heap buffers.
+		SingleLinkedList<std::string> expected;
+		for (int i = 0; i < 20; ++i) {
+			expected.PushFront(std::string(32, static_cast<char>('a' + i)));
+		}
+		FrozenList<std::string> frozen = Freeze(expected);
+		for (long budget = 0;; ++budget) {
+			g_allocation_budget = budget;
+			try {
+				SingleLinkedList<std::string> thawed = std::move(frozen).Thaw();
+				g_allocation_budget = -1;
+				assert(thawed == expected && frozen.IsEmpty());
+				break;
+			}
+			catch (const std::bad_alloc&) {
+				g_allocation_budget = -1;
+			}
+			assert(std::equal(frozen.begin(), frozen.end(), expected.begin(), expected.end()));
+		}
+	}
+
+	{
+		AllocationStats stats;
+		SingleLinkedList<int, CountingAllocator<int>> list(CountingAllocator<int>{ stats });
+		for (int i = 0; i < 100; ++i) {
+			list.PushFront(i);
+		}
+		const AllocationStats before = stats;
+		auto frozen = Freeze(std::move(list));
+		const AllocationStats delta = stats - before;
+		assert(delta.allocations == 1u && delta.deallocations == 100u);
+		assert(*frozen.begin() == 99);
+	}
+
+	{
+		std::vector<int64_t> values;
+		for (int64_t i = 0; i < 1000; ++i) {
+			values.push_back(i * 3);
+		}
+		values.push_back(std::numeric_limits<int64_t>::max());
+		values.push_back(std::numeric_limits<int64_t>::min());
+		values.push_back(-5);
+		for (int64_t i = 0; i < 100; ++i) {
+			values.push_back(-i * 1000);
+		}
+		CheckCompressedRoundTrip(values);
+		CheckCompressedRoundTrip(std::vector<uint8_t>{ 0, 255, 1, 128, 127 });
+		CheckCompressedRoundTrip(std::vector<uint32_t>{});
+		CheckCompressedRoundTrip(std::vector<int16_t>{ -32768, 32767, 0, 1, -1 });
+
+		SingleLinkedList<int> sorted;
+		for (int i = 10000; i > 0; --i) {
+			sorted.PushFront(i * 2);
+		}
+		const auto compressed = FreezeCompressed(sorted);
+		assert(compressed.GetEncodedBytes() == sorted.GetSize());
+	}
+}
+
+void Test20() {
+	{
+		AdaptivePolicy policy;
+		policy.evaluation_window = 64;
+		AdaptiveList<int> list(policy);
+		std::vector<int> expected;
+		unsigned state = 5;
+		auto next_random = [&state] {
+			state = state * 1103515245u + 12345u;
+			return state >> 8;
+		};
+
+		for (int step = 0; step < 20000; ++step) {
+			const unsigned roll = next_random() % 16;
+			if (roll < 4 || expected.empty()) {
+				list.PushFront(step);
+				expected.insert(expected.begin(), step);
+			}
+			else if (roll < 8) {
+				const size_t index = next_random() % (expected.size() + 1);
+				list.Insert(index, step);
+				expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(index), step);
+			}
+			else if (roll < 11) {
+				const size_t index = next_random() % expected.size();
+				list.Erase(index);
+				expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(index));
+			}
+			else if (roll < 15) {
+				const size_t index = next_random() % expected.size();
+				assert(list.At(index) == expected[index]);
+			}
+			else {
+				size_t index = 0;
+				list.ForEach([&](int value) {
+					assert(value == expected[index++]);
+				});
+				assert(index == expected.size());
+			}
+			assert(list.GetSize() == expected.size());
+		}
+		assert(list.GetStats().evaluations == 20000u / 64);
+
+		for (ListRepresentation target : { ListRepresentation::kUnrolled, ListRepresentation::kArray, ListRepresentation::kNodeList }) {
+			list.MigrateTo(target);
+			assert(list.GetRepresentation() == target);
+			size_t index = 0;
+			list.ForEach([&](int value) {
+				assert(value == expected[index++]);
+			});
+		}
+	}
+
+	{
+		AdaptiveList<int> list;
+		for (int i = 0; i < 2000; ++i) {
+			list.PushFront(i);
+		}
+		long sum = 0;
+		for (int round = 0; round < 20000; ++round) {
+			sum += list.At(static_cast<size_t>(round) % list.GetSize());
+		}
+		assert(sum > 0);
+		assert(list.GetRepresentation() == ListRepresentation::kArray);
+		assert(list.GetStats().migrations_to[static_cast<size_t>(ListRepresentation::kArray)] == 1u);
+		assert(list.GetStats().operations.random_accesses == 20000u);
+		assert(list.GetStats().operations.front_inserts == 2000u);
+
+		AdaptivePolicy policy;
+		policy.initial = ListRepresentation::kArray;
+		AdaptiveList<int> front_heavy(policy);
+		for (int i = 0; i < 30000; ++i) {
+			front_heavy.PushFront(i);
+		}
+		assert(front_heavy.GetRepresentation() == ListRepresentation::kUnrolled);
+		assert(front_heavy.At(0) == 29999);
+
+		struct Large {
+			std::array<char, 512> bytes{};
+		};
+		AdaptiveList<Large> large(policy);
+		for (int i = 0; i < 30000; ++i) {
+			large.PushFront(Large{});
+		}
+		assert(large.GetRepresentation() == ListRepresentation::kNodeList);
+
+		policy.enabled = false;
+		AdaptiveList<int> fixed(policy);
+		for (int i = 0; i < 30000; ++i) {
+			fixed.PushFront(i);
+		}
+		assert(fixed.GetRepresentation() == ListRepresentation::kArray);
+		assert(fixed.GetStats().migrations == 0u && fixed.GetStats().operations.front_inserts == 30000u);
+	}
+
+	{
+		// A migration invalidates references from At; the element is fetched
+		// again afterwards.
+		AdaptivePolicy policy;
+		policy.enabled = false;
+		AdaptiveList<int> list(policy);
+		for (int i = 0; i < 100; ++i) {
+			list.PushFront(i);
+		}
+		int& element = list.At(30);
+		element = -30;
+		for (ListRepresentation target : { ListRepresentation::kUnrolled, ListRepresentation::kArray, ListRepresentation::kNodeList }) {
+			list.MigrateTo(target);
+			assert(list.At(30) == -30);
+		}
+	}
+
+	{
+		// A migration the cost model asks for that runs out of memory is
+		// skipped; the access that triggered it still succeeds.
+		AdaptivePolicy policy;
+		policy.evaluation_window = 64;
+		AdaptiveList<int> list(policy);
+		for (int i = 0; i < 60; ++i) {
+			list.PushFront(i);
+		}
+		assert(list.GetStats().evaluations == 0u);
+		for (size_t round = 0; round < 640; ++round) {
+			const size_t index = (round * 7) % list.GetSize();
+			g_allocation_budget = 0;
+			const int value = list.At(index);
+			g_allocation_budget = -1;
+			assert(value == static_cast<int>(list.GetSize() - 1 - index));
+		}
+		assert(list.GetStats().evaluations == 700u / 64);
+		assert(list.GetRepresentation() == ListRepresentation::kNodeList && list.GetStats().migrations == 0u);
+
+		for (size_t round = 0; round < 640; ++round) {
+			assert(list.At(round % list.GetSize()) == static_cast<int>(list.GetSize() - 1 - round % list.GetSize()));
+		}
+		assert(list.GetRepresentation() == ListRepresentation::kArray);
+	}
+
+	{
+		// Unrolled blocks keep their elements inline: one allocation per block.
+		AdaptivePolicy policy;
+		policy.enabled = false;
+		AdaptiveList<int> list(policy);
+		for (int i = 0; i < 160; ++i) {
+			list.PushFront(i);
+		}
+		g_allocation_budget = 10;
+		list.MigrateTo(ListRepresentation::kUnrolled);
+		assert(g_allocation_budget == 0);
+		g_allocation_budget = -1;
+
+		AdaptiveList<int> copy = list;
+		list.Insert(40, -1);
+		assert(copy.GetSize() == 160u && list.GetSize() == 161u);
+		assert(list.At(40) == -1 && list.At(41) == copy.At(40));
+	}
+
+	{
+		// A migration that runs out of memory part way keeps every element.
+		// The strings are too long for the small-string buffer, so their moves
+		// are noexcept and actually steal the heap buffers.
+		const ListRepresentation kAll[] = { ListRepresentation::kNodeList, ListRepresentation::kUnrolled, ListRepresentation::kArray };
+		std::vector<std::string> expected;
+		for (int i = 0; i < 40; ++i) {
+			expected.emplace_back(32, static_cast<char>('a' + i % 26));
+		}
+		for (ListRepresentation from : kAll) {
+			for (ListRepresentation to : kAll) {
+				if (from == to) continue;
+				for (long budget = 0;; ++budget) {
+					AdaptivePolicy policy;
+					policy.initial = from;
+					policy.enabled = false;
+					AdaptiveList<std::string> list(policy);
+					for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+						list.PushFront(*it);
+					}
+
+					bool migrated = true;
+					g_allocation_budget = budget;
+					try {
+						list.MigrateTo(to);
+					}
+					catch (const std::bad_alloc&) {
+						migrated = false;
+					}
+					g_allocation_budget = -1;
+
+					assert(list.GetRepresentation() == (migrated ? to : from));
+					assert(list.GetSize() == expected.size());
+					size_t index = 0;
+					list.ForEach([&](const std::string& value) {
+						assert(value == expected[index++]);
+					});
+					if (migrated) break;
+				}
+			}
+		}
+	}
+
+	{
+		struct NoDefault {
+			explicit NoDefault(int v)
+				: value(v) {}
+			int value;
+		};
+		AdaptivePolicy policy;
+		policy.initial = ListRepresentation::kUnrolled;
+		policy.enabled = false;
+		AdaptiveList<NoDefault> list(policy);
+		for (int i = 0; i < 100; ++i) {
+			list.Insert(list.GetSize(), NoDefault(i));
+		}
+		assert(list.GetSize() == 100u && list.At(17).value == 17);
+	}
+
+	{
+		// Copyable with a throwing move: migration copies, so a failure
+		// leaves every element in place.
+		struct ThrowingCopy {
+			explicit ThrowingCopy(int v, int* countdown)
+				: value(v)
+				, countdown_ptr(countdown) {}
+			ThrowingCopy(const ThrowingCopy& other)
+				: value(other.value)
+				, countdown_ptr(other.countdown_ptr) {
+				if ((*countdown_ptr)-- == 0) {
+					throw std::runtime_error("copy failed");
+				}
+			}
+			ThrowingCopy(ThrowingCopy&& other) noexcept(false)
+				: ThrowingCopy(static_cast<const ThrowingCopy&>(other)) {}
+			ThrowingCopy& operator=(const ThrowingCopy&) = default;
+			int value;
+			int* countdown_ptr;
+		};
+
+		int countdown = 1000;
+		AdaptivePolicy policy;
+		policy.enabled = false;
+		AdaptiveList<ThrowingCopy> list(policy);
+		for (int i = 0; i < 10; ++i) {
+			list.Insert(list.GetSize(), ThrowingCopy(i, &countdown));
+		}
+		for (ListRepresentation target : { ListRepresentation::kArray, ListRepresentation::kUnrolled, ListRepresentation::kNodeList }) {
+			const ListRepresentation source = list.GetRepresentation();
+			countdown = 5;
+			bool exception_was_thrown = false;
+			try {
+				list.MigrateTo(target);
+			}
+			catch (const std::runtime_error&) {
+				exception_was_thrown = true;
+			}
+			assert(exception_was_thrown);
+			assert(list.GetRepresentation() == source && list.GetSize() == 10u);
+			int expected = 0;
+			list.ForEach([&expected](const ThrowingCopy& item) {
+				assert(item.value == expected++);
+			});
+			assert(expected == 10 && list.At(9).value == 9);
+
+			countdown = 1000;
+			list.MigrateTo(target);
+		}
+
+		// Move-only with a throwing move: the list stays consistent.
+		struct ThrowingMove {
+			explicit ThrowingMove(int* countdown)
+				: countdown_ptr(countdown) {}
+			ThrowingMove(ThrowingMove&& other) noexcept(false)
+				: countdown_ptr(other.countdown_ptr) {
+				if ((*countdown_ptr)-- == 0) {
+					throw std::runtime_error("move failed");
+				}
+			}
+			ThrowingMove& operator=(ThrowingMove&&) = default;
+			int* countdown_ptr;
+		};
+
+		countdown = 1000;
+		AdaptiveList<ThrowingMove> movable(policy);
+		for (int i = 0; i < 10; ++i) {
+			movable.PushFront(ThrowingMove(&countdown));
+		}
+		countdown = 4;
+		try {
+			movable.MigrateTo(ListRepresentation::kArray);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert(movable.GetRepresentation() == ListRepresentation::kNodeList && movable.GetSize() == 10u);
+		size_t visited = 0;
+		movable.ForEach([&visited](ThrowingMove&) { ++visited; });
+		assert(visited == 10u);
+		countdown = 1000;
+		movable.MigrateTo(ListRepresentation::kArray);
+		movable.Erase(9);
+		assert(movable.GetSize() == 9u);
+	}
+}
+
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+
+constexpr bool CheckConstexprList() {
+	SingleLinkedList<int> list{ 1, 2, 4 };
+	list.InsertAfter(std::next(list.cbegin()), 3);
+	list.PushFront(0);
+	list.EraseAfter(list.cbegin());
+	if (list != SingleLinkedList<int>{ 0, 2, 3, 4 } || list.GetSize() != 4) return false;
+
+	SingleLinkedList<int> copy = list;
+	SingleLinkedList<int> tail = copy.SplitAfter(copy.cbegin());
+	if (copy.GetSize() != 1 || tail != SingleLinkedList<int>{ 2, 3, 4 }) return false;
+	copy.Concat(std::move(tail));
+	if (copy != list || !tail.IsEmpty()) return false;
+
+	SingleLinkedList<int, std::allocator<int>, UntrackedSize> untracked{ 5, 6 };
+	untracked.PopFront();
+	return untracked.GetSize() == 1 && *untracked.begin() == 6;
+}
+
+static_assert(CheckConstexprList());
+
+constexpr auto kSquares = MaterializeList([] {
+	SingleLinkedList<int> squares;
+	for (int i = 5; i > 0; --i) {
+		squares.PushFront(i * i);
+	}
+	return squares;
+});
+
+static_assert(kSquares.GetSize() == 5 && kSquares[0] == 1 && kSquares[4] == 25);
+
+void Test21() {
+	const int expected[] = { 1, 4, 9, 16, 25 };
+	assert(std::equal(kSquares.begin(), kSquares.end(), std::begin(expected), std::end(expected)));
+
+	static constexpr auto kEmpty = MaterializeList([] { return SingleLinkedList<int>(); });
+	static_assert(kEmpty.IsEmpty());
+	assert(kEmpty.begin() == kEmpty.end());
+}
+
+#endif
+
+template <typename List>
+List MakeSortedList(const std::vector<int>& values, const typename List::allocator_type& alloc) {
+	List list(alloc);
+	auto pos = list.cbefore_begin();
+	for (int value : values) {
+		pos = list.InsertAfter(pos, value);
+	}
+	return list;
+}
+
+void Test22() {
+	AllocationStats stats;
+	using CountedList = SingleLinkedList<int, CountingAllocator<int>>;
+	const CountingAllocator<int> alloc(stats);
+
+	unsigned state = 11;
+	auto next_random = [&state] {
+		state = state * 1103515245u + 12345u;
+		return state >> 8;
+	};
+	auto random_sorted = [&](size_t count, unsigned range) {
+		std::vector<int> values(count);
+		for (int& value : values) {
+			value = static_cast<int>(next_random() % range);
+		}
+		std::sort(values.begin(), values.end());
+		return values;
+	};
+	auto to_vector = [](const CountedList& list) {
+		return std::vector<int>(list.begin(), list.end());
+	};
+
+	for (int round = 0; round < 200; ++round) {
+		const std::vector<int> a = random_sorted(next_random() % 60, 1 + next_random() % 80);
+		const std::vector<int> b = random_sorted(next_random() % 60, 1 + next_random() % 80);
+
+		std::vector<int> expected;
+		std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+		CountedList lhs = MakeSortedList<CountedList>(a, alloc);
+		CountedList rhs = MakeSortedList<CountedList>(b, alloc);
+		std::vector<const int*> addresses;
+		for (const int& value : lhs) {
+			addresses.push_back(&value);
+		}
+		AllocationStats before = stats;
+		lhs.UnionWith(std::move(rhs));
+		assert(to_vector(lhs) == expected && lhs.GetSize() == expected.size());
+		assert(rhs.IsEmpty() && rhs.GetSize() == 0u);
+		assert((stats - before).allocations == 0u);
+		assert((stats - before).deallocations == a.size() + b.size() - expected.size());
+		for (const int* address : addresses) {
+			assert(std::any_of(lhs.begin(), lhs.end(), [address](const int& value) { return &value == address; }));
+		}
+
+		expected.clear();
+		std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+		lhs = MakeSortedList<CountedList>(a, alloc);
+		rhs = MakeSortedList<CountedList>(b, alloc);
+		before = stats;
+		lhs.IntersectWith(rhs);
+		assert(to_vector(lhs) == expected && lhs.GetSize() == expected.size());
+		assert(to_vector(rhs) == b);
+		assert((stats - before).allocations == 0u && (stats - before).deallocations == a.size() - expected.size());
+
+		expected.clear();
+		std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+		lhs = MakeSortedList<CountedList>(a, alloc);
+		before = stats;
+		lhs.DifferenceWith(rhs);
+		assert(to_vector(lhs) == expected && lhs.GetSize() == expected.size());
+		assert((stats - before).allocations == 0u && (stats - before).deallocations == a.size() - expected.size());
+	}
+
+	{
+		CountedList list({ 1, 2, 2, 3 }, alloc);
+		list.IntersectWith(list);
+		assert(list == CountedList({ 1, 2, 2, 3 }, alloc));
+		list.DifferenceWith(list);
+		assert(list.IsEmpty());
+
+		SingleLinkedList<int, std::allocator<int>, UntrackedSize> descending{ 9, 7, 5, 3 };
+		descending.UnionWith({ 8, 7, 1 }, std::greater<>());
+		assert((descending == SingleLinkedList<int, std::allocator<int>, UntrackedSize>{ 9, 8, 7, 5, 3, 1 }));
+		descending.DifferenceWith({ 8, 3, 2 }, std::greater<>());
+		descending.IntersectWith({ 9, 6, 5, 1 }, std::greater<>());
+		assert((descending == SingleLinkedList<int, std::allocator<int>, UntrackedSize>{ 9, 5, 1 }));
+	}
+
+	{
+		int comparisons_left = 5;
+		auto throwing_less = [&comparisons_left](int lhs, int rhs) {
+			if (comparisons_left-- == 0) {
+				throw std::runtime_error("comparison failed");
+			}
+			return lhs < rhs;
+		};
+		CountedList lhs({ 1, 3, 5, 7, 9 }, alloc);
+		CountedList rhs({ 1, 2, 3, 4, 5 }, alloc);
+		try {
+			lhs.DifferenceWith(rhs, throwing_less);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert(std::is_sorted(lhs.begin(), lhs.end()));
+		assert(lhs.GetSize() == static_cast<size_t>(std::distance(lhs.begin(), lhs.end())));
+
+		comparisons_left = 3;
+		try {
+			lhs.UnionWith(std::move(rhs), throwing_less);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert(std::is_sorted(lhs.begin(), lhs.end()) && std::is_sorted(rhs.begin(), rhs.end()));
+		assert(lhs.GetSize() == static_cast<size_t>(std::distance(lhs.begin(), lhs.end())));
+		assert(rhs.GetSize() == static_cast<size_t>(std::distance(rhs.begin(), rhs.end())));
+	}
+
+	assert(stats.allocations == stats.deallocations);
+}
+
+void Test23() {
+	using Entry = std::pair<int, int>;
+	auto by_key = [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; };
+
+	unsigned state = 23;
+	auto next_random = [&state] {
+		state = state * 1103515245u + 12345u;
+		return state >> 8;
+	};
+	auto make_runs = [&](size_t run_count, size_t max_length, int key_range) {
+		std::vector<SingleLinkedList<Entry>> runs(run_count);
+		for (size_t run = 0; run < run_count; ++run) {
+			std::vector<int> keys(next_random() % (max_length + 1));
+			for (int& key : keys) {
+				key = static_cast<int>(next_random() % static_cast<unsigned>(key_range));
+			}
+			std::sort(keys.begin(), keys.end());
+			auto pos = runs[run].cbefore_begin();
+			for (int key : keys) {
+				pos = runs[run].InsertAfter(pos, Entry{ key, static_cast<int>(run) });
+			}
+		}
+		return runs;
+	};
+	auto stable_merge = [&](const std::vector<SingleLinkedList<Entry>>& runs) {
+		std::vector<Entry> entries;
+		for (const auto& run : runs) {
+			entries.insert(entries.end(), run.begin(), run.end());
+		}
+		std::stable_sort(entries.begin(), entries.end(), by_key);
+		return entries;
+	};
+
+	for (size_t thread_count : { size_t{ 1 }, size_t{ 4 } }) {
+		for (size_t run_count : { 0, 1, 2, 7, 64, 300 }) {
+			std::vector<SingleLinkedList<Entry>> runs = make_runs(run_count, 400, 1000);
+			const std::vector<Entry> expected = stable_merge(runs);
+			const auto merged = MergeAll(runs, by_key, thread_count);
+			assert(merged.GetSize() == expected.size());
+			assert(std::equal(merged.begin(), merged.end(), expected.begin(), expected.end()));
+			assert(std::all_of(runs.begin(), runs.end(), [](const auto& run) { return run.IsEmpty() && run.GetSize() == 0; }));
+		}
+	}
+
+	{
+		AllocationStats stats;
+		using CountedList = SingleLinkedList<int, CountingAllocator<int>, UntrackedSize>;
+		std::vector<CountedList> runs;
+		for (int run = 0; run < 3; ++run) {
+			runs.emplace_back(CountingAllocator<int>{ stats });
+			for (int value = 9; value >= 0; --value) {
+				runs.back().PushFront(value * 3 + run);
+			}
+		}
+		const AllocationStats before = stats;
+		const CountedList merged = CountedList::MergeAll(runs.begin(), runs.end());
+		assert((stats - before).allocations == 0u && (stats - before).deallocations == 0u);
+		assert(merged.GetSize() == 30u && std::is_sorted(merged.begin(), merged.end()));
+		assert(*merged.begin() == 0 && *std::next(merged.begin(), 29) == 29);
+	}
+
+	for (size_t thread_count : { size_t{ 1 }, size_t{ 4 } }) {
+		std::vector<SingleLinkedList<Entry>> runs = make_runs(40, 2000, 5000);
+		const std::vector<Entry> all = stable_merge(runs);
+		size_t comparisons_left = all.size() * 2;
+		std::mutex comparisons_mutex;
+		auto throwing_by_key = [&](const Entry& lhs, const Entry& rhs) {
+			std::lock_guard<std::mutex> lock(comparisons_mutex);
+			if (comparisons_left-- == 0) {
+				throw std::runtime_error("comparison failed");
+			}
+			return lhs.first < rhs.first;
+		};
+		try {
+			(void)MergeAll(runs, throwing_by_key, thread_count);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		for (const auto& run : runs) {
+			assert(std::is_sorted(run.begin(), run.end(), by_key));
+			assert(run.GetSize() == static_cast<size_t>(std::distance(run.begin(), run.end())));
+		}
+		comparisons_left = std::numeric_limits<size_t>::max();
+		const auto merged = MergeAll(runs, throwing_by_key, thread_count);
+		std::vector<Entry> recovered(merged.begin(), merged.end());
+		std::vector<Entry> sorted_all = all;
+		std::sort(recovered.begin(), recovered.end());
+		std::sort(sorted_all.begin(), sorted_all.end());
+		assert(recovered == sorted_all);
+	}
+}
+
+void Test24() {
+	using Operation = BatchOperation<int>;
+	auto apply_to_vector = [](const std::vector<int>& original, const std::vector<Operation>& operations) {
+		std::vector<int> result;
+		size_t index = 0;
+		for (const Operation& operation : operations) {
+			for (; index < operation.index; ++index) {
+				result.push_back(original[index]);
+			}
+			if (operation.kind != BatchOperationKind::kInsert) {
+				++index;
+			}
+			if (operation.kind != BatchOperationKind::kErase) {
+				result.push_back(*operation.value);
+			}
+		}
+		result.insert(result.end(), original.begin() + static_cast<std::ptrdiff_t>(index), original.end());
+		return result;
+	};
+
+	unsigned state = 24;
+	auto next_random = [&state] {
+		state = state * 1103515245u + 12345u;
+		return state >> 8;
+	};
+
+	AllocationStats stats;
+	using CountedList = SingleLinkedList<int, CountingAllocator<int>>;
+	for (int round = 0; round < 300; ++round) {
+		std::vector<int> original(next_random() % 50);
+		std::iota(original.begin(), original.end(), 0);
+
+		std::vector<Operation> operations;
+		size_t erased = 0;
+		size_t created = 0;
+		for (size_t index = 0; index <= original.size(); ++index) {
+			while (next_random() % 4 == 0) {
+				operations.push_back({ index, BatchOperationKind::kInsert, 1000 + round });
+				++created;
+			}
+			if (index < original.size() && next_random() % 3 == 0) {
+				const bool replace = next_random() % 2 == 0;
+				operations.push_back({ index, replace ? BatchOperationKind::kReplace : BatchOperationKind::kErase,
+					replace ? std::optional<int>(-static_cast<int>(index)) : std::nullopt });
+				++erased;
+				created += replace;
+			}
+		}
+
+		CountedList list(CountingAllocator<int>{ stats });
+		auto pos = list.cbefore_begin();
+		for (int value : original) {
+			pos = list.InsertAfter(pos, value);
+		}
+		const AllocationStats before = stats;
+		list.ApplyBatch(operations);
+		const std::vector<int> expected = apply_to_vector(original, operations);
+		assert(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+		assert(list.GetSize() == expected.size());
+		assert((stats - before).allocations == created && (stats - before).deallocations == erased);
+	}
+	assert(stats.allocations == stats.deallocations);
+
+	{
+		SingleLinkedList<std::unique_ptr<int>, std::allocator<std::unique_ptr<int>>, UntrackedSize> owners;
+		owners.PushFront(std::make_unique<int>(2));
+		owners.PushFront(std::make_unique<int>(1));
+		std::vector<BatchOperation<std::unique_ptr<int>>> operations(3);
+		operations[0] = { 0, BatchOperationKind::kReplace, std::make_unique<int>(10) };
+		operations[1] = { 2, BatchOperationKind::kInsert, std::make_unique<int>(30) };
+		operations[2] = { 2, BatchOperationKind::kInsert, std::make_unique<int>(40) };
+		owners.ApplyBatch(std::make_move_iterator(operations.begin()), std::make_move_iterator(operations.end()));
+		std::vector<int> values;
+		for (const auto& owner : owners) {
+			values.push_back(*owner);
+		}
+		assert((values == std::vector<int>{ 10, 2, 30, 40 }));
+		assert(owners.GetSize() == 4u);
+	}
+
+	{
+		struct CopyCountdown {
+			explicit CopyCountdown(int* countdown)
+				: countdown_ptr(countdown) {}
+			CopyCountdown(const CopyCountdown& other)
+				: countdown_ptr(other.countdown_ptr) {
+				if ((*countdown_ptr)-- == 0) {
+					throw std::runtime_error("copy failed");
+				}
+			}
+			CopyCountdown& operator=(const CopyCountdown&) = default;
+			int* countdown_ptr;
+		};
+
+		int countdown = 100;
+		AllocationStats throwing_stats;
+		SingleLinkedList<CopyCountdown, CountingAllocator<CopyCountdown>> list(CountingAllocator<CopyCountdown>{ throwing_stats });
+		for (int i = 0; i < 5; ++i) {
+			list.PushFront(CopyCountdown(&countdown));
+		}
+		std::vector<const CopyCountdown*> addresses;
+		for (const CopyCountdown& item : list) {
+			addresses.push_back(&item);
+		}
+
+		std::vector<BatchOperation<CopyCountdown>> operations;
+		operations.push_back({ 0, BatchOperationKind::kErase, std::nullopt });
+		operations.push_back({ 2, BatchOperationKind::kInsert, CopyCountdown(&countdown) });
+		operations.push_back({ 3, BatchOperationKind::kReplace, CopyCountdown(&countdown) });
+		countdown = 1;
+		const AllocationStats before = throwing_stats;
+		try {
+			list.ApplyBatch(operations);
+			assert(false);
+		}
+		catch (const std::runtime_error&) {
+		}
+		assert((throwing_stats - before).allocations == (throwing_stats - before).deallocations);
+		assert(list.GetSize() == 5u);
+		size_t index = 0;
+		for (const CopyCountdown& item : list) {
+			assert(&item == addresses[index++]);
+		}
+	}
+}
+
+void Test25() {
+	{
+		SingleLinkedList<int> numbers{ 1, 5 };
+		const std::vector<int> middle{ 2, 3, 4 };
+		auto last = numbers.InsertAfter(numbers.cbegin(), middle.begin(), middle.end());
+		assert(*last == 4 && numbers == SingleLinkedList<int>({ 1, 2, 3, 4, 5 }));
+		assert(numbers.GetSize() == 5u);
+
+		last = numbers.InsertAfter(numbers.cbegin(), middle.end(), middle.end());
+		assert(last == numbers.begin() && numbers.GetSize() == 5u);
+
+		std::istringstream input("6 7");
+		last = numbers.InsertAfter(std::next(numbers.cbegin(), 4), std::istream_iterator<int>(input), std::istream_iterator<int>());
+		assert(*last == 7 && numbers == SingleLinkedList<int>({ 1, 2, 3, 4, 5, 6, 7 }));
+
+		auto next = numbers.EraseAfter(numbers.cbegin(), std::next(numbers.cbegin(), 4));
+		assert(*next == 5 && numbers == SingleLinkedList<int>({ 1, 5, 6, 7 }));
+		assert(numbers.GetSize() == 4u);
+
+		next = numbers.EraseAfter(numbers.cbegin(), std::next(numbers.cbegin()));
+		assert(*next == 5 && numbers.GetSize() == 4u);
+
+		next = numbers.EraseAfter(numbers.cbefore_begin(), numbers.cend());
+		assert(next == numbers.end() && numbers.IsEmpty() && numbers.GetSize() == 0u);
+
+		SingleLinkedList<std::string, std::allocator<std::string>, UntrackedSize> words;
+		const char* const literals[] = { "alpha", "beta" };
+		words.InsertAfter(words.cbefore_begin(), std::begin(literals), std::end(literals));
+		words.EraseAfter(words.cbegin(), words.cend());
+		assert((words == SingleLinkedList<std::string, std::allocator<std::string>, UntrackedSize>{ "alpha" }));
+	}
+
+	{
+		int countdown = 3;
+		std::vector<ThrowOnCopyForCompact> values(5);
+		for (auto& value : values) {
+			value.countdown_ptr = &countdown;
+		}
+		AllocationStats stats;
+		SingleLinkedList<ThrowOnCopyForCompact, CountingAllocator<ThrowOnCopyForCompact>> list(CountingAllocator<ThrowOnCopyForCompact>{ stats });
+		list.PushFront(ThrowOnCopyForCompact());
+		list.PushFront(ThrowOnCopyForCompact());
+		const ThrowOnCopyForCompact* first = &*list.begin();
+
+		const AllocationStats before = stats;
+		bool exception_was_thrown = false;
+		try {
+			list.InsertAfter(list.cbegin(), values.begin(), values.end());
+		}
+		catch (const std::bad_alloc&) {
+			exception_was_thrown = true;
+		}
+		assert(exception_was_thrown);
+		assert((stats - before).allocations == 4u && (stats - before).deallocations == 4u);
+		assert(list.GetSize() == 2u && &*list.begin() == first);
+		assert(std::distance(list.begin(), list.end()) == 2);
+	}
+}
+
+int main() {
+	Test4();
+	Test5();
+	Test6();
+	Test7();
+	Test8();
+	Test9();
+	Test10();
+	Test11();
+	Test12();
+	Test13();
+	Test14();
+	Test15();
+	Test16();
+	Test17();
+	Test18();
+	Test19();
+	Test20();
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+	Test21();
+#endif
+	Test22();
+	Test23();
+	Test24();
+	Test25();
+	return 0;
+}